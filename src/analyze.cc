@@ -1,16 +1,22 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <iostream>
+#include <set>
 #include <string>
 #include <sstream>
 
 #include <readline/readline.h>
 #include <readline/history.h>
 
+#include <sys/resource.h>
+
 #include <json/json.h>
 #include <json/reader.h>
 
 #include <Array.h>
+#include <LineFile.h>
 #include <Map.h>
 #include <veri_file.h>
 #include <VeriId.h>
@@ -20,11 +26,209 @@
 #include <VeriStatement.h>
 
 #include "structs.h"
+#include "budget.h"
+#include "cache.h"
+#include "cut.h"
 #include "dependence.h"
+#include "flow.h"
+#include "forward.h"
+#include "multi.h"
+#include "pair.h"
+#include "pool.h"
+#include "reach.h"
+#include "snapshot.h"
+#include "sources.h"
+#include "summary.h"
 
 using namespace Verific;
 module_map_t module_map;
 
+// Source files of the design and the modules they define (see reload).
+source_table_t source_table;
+
+// Module summaries, if requested (see --summaries).
+summary_table_t* summary_table = nullptr;
+
+// Compiled value-flow graph of the design, if requested (see --flow-graph).
+flow_graph_t* flow_graph = nullptr;
+
+// Transitive closure of the port dependences, if requested (see --build-index)
+// or loaded from a snapshot.
+reach_index_t* reach_index = nullptr;
+
+// Worker threads for JSON batches (see --threads).
+uint32_t thread_count = 1;
+
+// Signals of a JSON spec traced together (see --signals-per-pass).
+uint32_t signals_per_pass = multi_dep_analysis_t::k_max_queries;
+
+// Trace the two leak classes in separate passes (see --separate-channels).
+bool separate_channels = false;
+
+// Limits of a query; zero is unlimited, except for the registers that a
+// query may cross, which are unlimited if util_t::k_no_index.
+typedef struct {
+    uint64_t milliseconds;
+    uint64_t pops;
+    uint64_t megabytes;
+    uint32_t cycles;
+} query_limits_t;
+
+// Limits of every query (see --max-query-ms, --max-query-pops,
+// --max-query-mb and --max-cycles), which JSON entries may override.
+query_limits_t query_limits = { 0, 0, 0, util_t::k_no_index };
+
+// Nets at which every query stops, if any (see --cut), which JSON specs may
+// extend.
+cut_set_t* cut_set = nullptr;
+
+// Results of earlier queries, if enabled (see --cache-mb).
+query_cache_t* query_cache = nullptr;
+
+// Workers that build dominators in the background of the REPL, if any (see
+// --warm-up-threads).
+thread_pool_t* warm_up_pool = nullptr;
+std::atomic<bool> warm_up_cancelled(false);
+
+typedef std::chrono::steady_clock::time_point time_point_t;
+
+bool report_timing = false;
+
+/*! \brief print the time elapsed since 'start' if requested (see --time).
+ */
+void report_time(const std::string& what, time_point_t start) {
+    if (report_timing == false) {
+        return;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    char message[256];
+    snprintf(message, sizeof(message), "[time] %s: %.3f ms\n", what.c_str(),
+            elapsed.count());
+
+    util_t::plain(message);
+}
+
+/*! \brief print the time and per-instruction cost of a query if requested.
+ */
+void report_query_time(const std::string& what, time_point_t start,
+        dep_analysis_t& dep_analysis) {
+    if (report_timing == false) {
+        return;
+    }
+
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    char message[256];
+
+    if (dep_analysis.from_cache()) {
+        snprintf(message, sizeof(message), "[time] %s: %.3f ms, cached\n",
+                what.c_str(), elapsed.count() / 1e6);
+
+        util_t::plain(message);
+        return;
+    }
+
+    uint64_t instrs = dep_analysis.visited_instrs();
+    double per_instr = instrs > 0 ? elapsed.count() / instrs : 0;
+
+    snprintf(message, sizeof(message), "[time] %s: %.3f ms, %lu "
+            "instruction(s), %.1f ns/instruction\n", what.c_str(),
+            elapsed.count() / 1e6, instrs, per_instr);
+
+    util_t::plain(message);
+}
+
+/*! \brief print the peak RSS and the size of the IR arenas if requested.
+ */
+void report_memory(const std::string& what) {
+    if (report_timing == false) {
+        return;
+    }
+
+    size_t arena_bytes = 0, arena_chunks = 0;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        arena_t& arena = it->second->arena();
+
+        arena_bytes += arena.bytes_reserved();
+        arena_chunks += arena.chunk_count();
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // ru_maxrss is in kilobytes on Linux.
+    char message[256];
+    snprintf(message, sizeof(message), "[mem] %s: peak RSS %.1f MB, IR arenas "
+            "%.1f MB in %zd chunk(s)\n", what.c_str(), usage.ru_maxrss / 1024.0,
+            arena_bytes / (1024.0 * 1024.0), arena_chunks);
+
+    util_t::plain(message);
+}
+
+/*! \brief check whether any resource of a query is limited.
+ */
+bool limited(const query_limits_t& limits) {
+    return limits.milliseconds > 0 || limits.pops > 0 || limits.megabytes > 0;
+}
+
+/*! \brief check whether a query may only cross a limited number of
+ * registers.
+ */
+bool bounded(const query_limits_t& limits) {
+    return limits.cycles != util_t::k_no_index;
+}
+
+/*! \brief the limits of a JSON entry: its "max_ms", "max_pops", "max_mb" and
+ * "max_cycles" fields, or else the limits of every query.
+ */
+query_limits_t entry_limits(const Json::Value& entry) {
+    query_limits_t limits = query_limits;
+
+    if (entry.isMember("max_ms")) {
+        limits.milliseconds = entry["max_ms"].asUInt64();
+    }
+
+    if (entry.isMember("max_pops")) {
+        limits.pops = entry["max_pops"].asUInt64();
+    }
+
+    if (entry.isMember("max_mb")) {
+        limits.megabytes = entry["max_mb"].asUInt64();
+    }
+
+    if (entry.isMember("max_cycles")) {
+        limits.cycles = std::min<uint64_t>(entry["max_cycles"].asUInt64(),
+                util_t::k_no_index - 1);
+    }
+
+    return limits;
+}
+
+/*! \brief warn that a query ran out of budget.
+ */
+void warn_truncated(const std::string& what, query_budget_t& budget) {
+    util_t::warn("'" + what + "' reached its " +
+            query_budget_t::limit_name(budget.exhausted_limit()) +
+            " limit; the results are partial.\n");
+}
+
+/*! \brief mark a JSON result as partial if its query ran out of budget.
+ */
+void add_truncation(Json::Value& result, query_budget_t& budget) {
+    uint8_t limit = budget.exhausted_limit();
+
+    result["truncated"] = limit != query_budget_t::LIMIT_NONE;
+
+    if (limit != query_budget_t::LIMIT_NONE) {
+        result["reason"] = query_budget_t::limit_name(limit);
+    }
+}
+
 void destroy_module_map() {
     for (auto it = module_map.begin(); it != module_map.end(); it++) {
         module_t* module_ds = it->second;
@@ -36,6 +240,12 @@ void destroy_module_map() {
     module_map.clear();
 }
 
+/*! \brief build the IR of every module that Verific parsed.
+ *
+ * This walks Verific's parse trees, which are not documented to be
+ * thread-safe, so it is serial even with --load-threads; it also keeps the
+ * order in which symbols are interned deterministic.
+ */
 uint32_t parse_modules() {
     MapIter map_iter;
     VeriModule* module = nullptr;
@@ -54,13 +264,74 @@ uint32_t parse_modules() {
         util_t::update_status(status);
 
         module_t* module_ds = new module_t(module);
-        module_map.emplace(module_ds->name(), module_ds);
+
+        if (module_map.emplace(module_ds->name(), module_ds).second == false) {
+            delete module_ds;
+            continue;
+        }
+
+        source_table.add_module(LineFile::GetFileName(module->Linefile()),
+                module_ds->name());
     }
 
     util_t::clear_status();
     return module_map.size();
 }
 
+/*! \brief resolve module instantiations and build the def-use chains.
+ *
+ * Neither step touches Verific's parse trees.  With a pool, every module
+ * resolves its own instantiations concurrently.
+ * The def-use edges that belong to invoked modules are buffered per module,
+ * merged in module order, and added along with each module's own def-use
+ * chains, again concurrently.
+ */
+void link_modules(thread_pool_t* pool) {
+    if (pool == nullptr) {
+        for (auto it = module_map.begin(); it != module_map.end(); it++) {
+            module_t* module_ds = it->second;
+            module_ds->resolve_links(module_map);
+        }
+
+        for (auto it = module_map.begin(); it != module_map.end(); it++) {
+            module_t* module_ds = it->second;
+
+            module_ds->build_def_use_chains();
+            // module_ds->print_undef_ids();
+        }
+
+        return;
+    }
+
+    std::vector<module_t*> modules;
+    std::unordered_map<module_t*, size_t> module_index;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        module_index[it->second] = modules.size();
+        modules.push_back(it->second);
+    }
+
+    std::vector<link_list_t> remote_links(modules.size());
+
+    pool->parallel_for(modules.size(), [&modules, &remote_links](size_t idx) {
+        modules[idx]->resolve_links(module_map, remote_links[idx]);
+    });
+
+    std::vector<link_list_t> incoming_links(modules.size());
+
+    for (link_list_t& links : remote_links) {
+        for (link_t& link : links) {
+            incoming_links[module_index[link.module_ds]].push_back(link);
+        }
+    }
+
+    pool->parallel_for(modules.size(), [&modules, &incoming_links](
+            size_t idx) {
+        modules[idx]->build_def_use_chains();
+        modules[idx]->add_links(incoming_links[idx]);
+    });
+}
+
 bool analyze_file(const char* filename) {
     if (veri_file::Analyze(filename, veri_file::SYSTEM_VERILOG) == false) {
         assert(false && "failed to analyze file!");
@@ -73,7 +344,7 @@ bool analyze_file(const char* filename) {
 const char* suffix = nullptr;
 
 char* name_gen(const char *__text, int state) {
-    static id_list_t matches;
+    static name_list_t matches;
     static size_t match_index = 0;
 
     if (state == 0) {
@@ -112,7 +383,10 @@ char* name_gen(const char *__text, int state) {
 
             module_t* module_ds = it->second;
 
-            for (identifier_t port : module_ds->ports()) {
+            name_list_t ports;
+            util_t::sorted_names(module_ds->ports(), ports);
+
+            for (identifier_t port : ports) {
                 identifier_t lcase_port = port;
                 std::transform(lcase_port.begin(), lcase_port.end(),
                         lcase_port.begin(), ::tolower);
@@ -156,13 +430,35 @@ void process_text(const char* __buffer) {
         return;
     }
 
+    query_budget_t budget(query_limits.milliseconds, query_limits.pops,
+            query_limits.megabytes);
+
     dep_analysis_t dep_analysis;
+    dep_analysis.use_summaries(summary_table);
+    dep_analysis.use_cache(query_cache);
+    dep_analysis.use_separate_channels(separate_channels);
+    dep_analysis.use_graph(flow_graph);
+    dep_analysis.use_cuts(cut_set);
+    dep_analysis.use_cycle_bound(query_limits.cycles);
+
+    if (limited(query_limits)) {
+        dep_analysis.use_budget(&budget);
+    }
 
     std::string buffer(__buffer);
     std::string mod_name = buffer.substr(0, separator - __buffer);
     std::string field = std::string(separator + 1);
 
-    if (dep_analysis.compute_dependencies(mod_name, field, module_map)) {
+    time_point_t start = std::chrono::steady_clock::now();
+    bool leaks = dep_analysis.compute_dependencies(mod_name, field, module_map);
+    report_query_time(buffer, start, dep_analysis);
+
+    if (dep_analysis.truncated()) {
+        util_t::clear_status();
+        warn_truncated(buffer, budget);
+    }
+
+    if (leaks) {
         util_t::update_status("\n");
 
         id_set_t& timing_deps = dep_analysis.leaking_timing_deps();
@@ -187,162 +483,1603 @@ void process_text(const char* __buffer) {
     }
 }
 
-void do_repl() {
-    char* buffer = nullptr;
-    while ((buffer = readline(">> ")) != nullptr) {
-        if (strlen(buffer) == 0) {
-            continue;
-        } else if (strcmp(buffer, "quit") != 0) {
-            add_history(buffer);
-            process_text(buffer);
-            free(buffer);
-        } else {
-            free(buffer);
-            break;
-        }
+/*! \brief list the ports that may leak into a port, using the reachability
+ * index.
+ */
+void process_reach(const char* __buffer) {
+    const char* separator = strchr(__buffer, '.');
+
+    if (separator == nullptr) {
+        util_t::warn("need reach <module>.<port>, found '" +
+                identifier_t(__buffer) + "'\n");
+        return;
     }
-}
 
-void do_one_signal(std::string mod, std::string fld, int &outIdx, Json::Value &out) {
-    dep_analysis_t dep_analysis;
+    if (reach_index == nullptr) {
+        util_t::warn("no reachability index, see --build-index.\n");
+        return;
+    }
 
-    bool compute = dep_analysis.compute_dependencies(mod,
-                                                     fld,
-                                                     module_map);
-    if (compute) {
-        Json::Value result;
-        id_set_t& timing_deps = dep_analysis.leaking_timing_deps();
-        id_set_t& non_timing_deps = dep_analysis.leaking_non_timing_deps();
+    std::string buffer(__buffer);
+    std::string mod_name = buffer.substr(0, separator - __buffer);
+    std::string field = std::string(separator + 1);
 
-        int idx = 0;
-        for (auto id : timing_deps) {
-            result["timing"][idx] = id;
-            idx++;
-        }
+    module_map_t::iterator it = module_map.find(mod_name);
+    id_set_t timing_deps, non_timing_deps;
 
-        idx = 0;
-        for (auto id : non_timing_deps) {
-            result["non_timing"][idx] = id;
-            idx++;
-        }
-        result["module"] = mod;
-        result["field"]  = fld;
-        out[outIdx] = result;
-    } else {
-        out[outIdx]["module"] = mod;
-        out[outIdx]["field"]  = fld;
-        out[outIdx]["non_timing"] = Json::Value(Json::arrayValue);
-        out[outIdx]["timing"] = Json::Value(Json::arrayValue);
+    time_point_t start = std::chrono::steady_clock::now();
+
+    if (it == module_map.end() || reach_index->trace(it->second,
+                symtab_t::intern(field), timing_deps, non_timing_deps) ==
+            false) {
+        util_t::warn("'" + buffer + "' is not an indexed port.\n");
+        return;
+    }
+
+    report_time(buffer, start);
+
+    if (timing_deps.size() > 0) {
+        util_t::underline("may leak through timing:");
+        util_t::dump_set(timing_deps);
+    }
+
+    if (non_timing_deps.size() > 0) {
+        util_t::underline("may leak through non-timing:");
+        util_t::dump_set(non_timing_deps);
+    }
+
+    if (timing_deps.size() == 0 && non_timing_deps.size() == 0) {
+        util_t::plain("no port leaks into '" + buffer + "'.\n");
     }
-    outIdx++;
 }
 
+/*! \brief list the ports that an identifier flows into ("flows" command).
+ */
+void process_flows(const char* __buffer) {
+    const char* separator = strchr(__buffer, '.');
 
-Json::Value processJSON(Json::Value root) {
-    int outIdx = 0;
-    Json::Value out(Json::arrayValue);
+    if (separator == nullptr) {
+        util_t::warn("need flows <module>.<id>, found '" +
+                identifier_t(__buffer) + "'\n");
+        return;
+    }
 
-    for (auto s : root["signals"]) {
-        std::string mod = s["module"].asString().c_str();
-        std::string fld = s["field"].asString().c_str();
-        std::vector<std::string> fields;
-        if (fld.back() == '*') {
-            fld.pop_back();
+    std::string buffer(__buffer);
+    std::string mod_name = buffer.substr(0, separator - __buffer);
+    std::string field = std::string(separator + 1);
 
-            module_map_t::iterator it = module_map.find(mod);
-            module_t* module_ds = it->second;
+    if (module_map.find(mod_name) == module_map.end()) {
+        util_t::warn("no module named '" + mod_name + "'\n");
+        return;
+    }
 
-            for (identifier_t port : module_ds->ports()) {
-                identifier_t lcase_port = port;
-                std::transform(lcase_port.begin(), lcase_port.end(),
-                               lcase_port.begin(), ::tolower);
+    query_budget_t budget(query_limits.milliseconds, query_limits.pops,
+            query_limits.megabytes);
 
-                if (lcase_port.size() >= fld.size() &&
-                    lcase_port.compare(0, fld.size(), fld) == 0) {
-                    fields.push_back(port);
-                }
-            }
-        } else {
-            fields.push_back(fld);
-        }
+    forward_analysis_t forward_analysis;
+    forward_analysis.use_graph(flow_graph);
+    forward_analysis.use_cuts(cut_set);
+    forward_analysis.use_cycle_bound(query_limits.cycles);
 
-        for (auto fld : fields) {
-            do_one_signal(mod, fld, outIdx, out);
-        }
+    if (limited(query_limits)) {
+        forward_analysis.use_budget(&budget);
     }
 
-    return out;
-}
+    time_point_t start = std::chrono::steady_clock::now();
+    bool flows = forward_analysis.compute_flows(mod_name, field, module_map);
+    report_time(buffer, start);
 
-int main(int argc, char **argv) {
-    bool interactive = true;
-    std::vector<std::string> sourceFiles;
-    Json::Value root;
+    util_t::clear_status();
 
-    if (argc < 2) {
-        std::cout << root;
-        std::cerr << "USAGE: " << argv[0] << " verilog-files";
-        std::cerr << "       " << argv[0] << " <JSON spec>";
-        return 1;
+    if (forward_analysis.truncated()) {
+        warn_truncated(buffer, budget);
     }
 
-    if (argc == 2) {
-        // Try to parse a JSON spec
-        std::ifstream file;
-        file.open(argv[1]);
-        Json::CharReaderBuilder builder;
-        builder["collectComments"] = false;
-        std::string errs;
-        bool ok = Json::parseFromStream(builder, file, &root, &errs);
-        if (ok) {
-            interactive = false;
-            // TODO: Check JSON schema (is that a thing?)
-            for (int i = 0; i < root["sources"].size(); i++) {
-                sourceFiles.push_back(root["sources"][i].asString());
-            }
-        }
+    if (flows == false) {
+        util_t::plain("'" + buffer + "' does not flow into any port.\n");
+        return;
     }
 
-    if (interactive) {
-        for (int i = 1; i < argc; i++) {
-            sourceFiles.push_back(std::string(argv[i]));
-        }
+    id_set_t& timing_sinks = forward_analysis.timing_sinks();
+
+    if (timing_sinks.size() > 0) {
+        util_t::underline("flows through timing into:");
+        util_t::dump_set(timing_sinks);
     }
 
-    Message::SetMessageType("VERI-1482", VERIFIC_IGNORE);
+    id_set_t& non_timing_sinks = forward_analysis.non_timing_sinks();
 
-    util_t::update_status("analyzing input files ... ");
+    if (non_timing_sinks.size() > 0) {
+        util_t::underline("flows through non-timing into:");
+        util_t::dump_set(non_timing_sinks);
+    }
+}
+
+/*! \brief compile the value-flow graph of the design (see --flow-graph).
+ */
+flow_graph_t* build_flow_graph(thread_pool_t* pool) {
+    time_point_t graph_start = std::chrono::steady_clock::now();
+
+    flow_graph_t* graph = new flow_graph_t();
+    graph->build(module_map, pool);
 
-    for (auto f : sourceFiles) {
-        analyze_file(f.c_str());
+    report_time("flow graph", graph_start);
+    report_memory("flow graph");
+
+    return graph;
+}
+
+/*! \brief compile the flow graph the first time a query needs it.
+ */
+void require_flow_graph() {
+    if (flow_graph == nullptr) {
+        util_t::plain("compiling the flow graph (see --flow-graph) ...\n");
+        flow_graph = build_flow_graph(nullptr);
     }
+}
 
-    parse_modules();
+/*! \brief split "<module>.<id>" into its parts; false if malformed or if
+ * the module does not exist.
+ */
+bool split_signal(const std::string& signal, std::string& mod_name,
+        std::string& field) {
+    size_t separator = signal.find('.');
 
-    util_t::update_status("building def-use chains ... ");
+    if (separator == std::string::npos) {
+        util_t::warn("need <module>.<id>, found '" + signal + "'\n");
+        return false;
+    }
 
-    for (auto it = module_map.begin(); it != module_map.end(); it++) {
-        module_t* module_ds = it->second;
-        module_ds->resolve_links(module_map);
+    mod_name = signal.substr(0, separator);
+    field = signal.substr(separator + 1);
+
+    if (module_map.find(mod_name) == module_map.end()) {
+        util_t::warn("no module named '" + mod_name + "'\n");
+        return false;
     }
 
-    for (auto it = module_map.begin(); it != module_map.end(); it++) {
-        module_t* module_ds = it->second;
+    return true;
+}
 
-        module_ds->build_def_use_chains();
-        // module_ds->print_undef_ids();
+/*! \brief check whether a source leaks into a sink ("pair" command).
+ */
+void process_pair(const char* __buffer) {
+    std::string buffer(__buffer);
+    size_t space = buffer.find(' ');
+
+    if (space == std::string::npos) {
+        util_t::warn("need pair <module>.<source> <module>.<sink>, found '" +
+                buffer + "'\n");
+        return;
+    }
+
+    std::string source = buffer.substr(0, space);
+    std::string sink = buffer.substr(space + 1);
+    std::string source_mod, source_field, sink_mod, sink_field;
+
+    if (split_signal(source, source_mod, source_field) == false ||
+            split_signal(sink, sink_mod, sink_field) == false) {
+        return;
+    }
+
+    require_flow_graph();
+
+    query_budget_t budget(query_limits.milliseconds, query_limits.pops,
+            query_limits.megabytes);
+
+    pair_analysis_t pair_analysis;
+    pair_analysis.use_graph(flow_graph);
+    pair_analysis.use_index(reach_index);
+    pair_analysis.use_cuts(cut_set);
+
+    if (limited(query_limits)) {
+        pair_analysis.use_budget(&budget);
     }
 
+    time_point_t start = std::chrono::steady_clock::now();
+    pair_analysis.compute_pair(source_mod, source_field, sink_mod, sink_field,
+            module_map);
+    report_time(source + " -> " + sink, start);
+
     util_t::clear_status();
-    rl_attempted_completion_function = complete_text;
 
-    if (interactive) {
-        do_repl();
-    } else {
-        Json::Value out = processJSON(root);
-        std::cout << out << std::endl;
+    if (pair_analysis.truncated()) {
+        warn_truncated(source + " -> " + sink, budget);
+    }
+
+    state_t leaks = pair_analysis.leak_types();
+
+    if (leaks & DEP_TIMING) {
+        util_t::plain("'" + source + "' leaks into '" + sink +
+                "' through timing.\n");
+    }
+
+    if (leaks & DEP_ORDINARY) {
+        util_t::plain("'" + source + "' leaks into '" + sink +
+                "' through non-timing.\n");
     }
 
+    if (leaks == 0) {
+        util_t::plain("'" + source + "' does not leak into '" + sink +
+                "'.\n");
+    }
+}
+
+/*! \brief build the reachability index of the design (see --build-index).
+ *
+ * The index is built from the flow graph, which is compiled for the occasion
+ * if --flow-graph was not given.
+ */
+void build_reach_index(uint32_t thread_count) {
+    thread_pool_t* index_pool = nullptr;
+
+    if (thread_count > 1) {
+        index_pool = new thread_pool_t(thread_count);
+    }
+
+    flow_graph_t* graph = flow_graph;
+
+    if (graph == nullptr) {
+        graph = build_flow_graph(index_pool);
+    }
+
+    time_point_t index_start = std::chrono::steady_clock::now();
+
+    reach_index = new reach_index_t();
+    reach_index->build(*graph, index_pool);
+
+    if (graph != flow_graph) {
+        delete graph;
+    }
+
+    delete index_pool;
+
+    report_time("reachability index", index_start);
+    report_memory("reachability index");
+}
+
+/*! \brief build the dominators of all modules in the background.
+ *
+ * Modules are queued largest first, since those take the longest.  Queries
+ * that reach a module before its turn build its dominators themselves, and
+ * queries that reach a module while it is being built wait for it (see
+ * module_t::build_dominator_sets()).
+ */
+void start_warm_up(uint32_t thread_count) {
+    std::vector<module_t*> modules;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        modules.push_back(it->second);
+    }
+
+    std::stable_sort(modules.begin(), modules.end(),
+            [](module_t* lhs, module_t* rhs) {
+        return lhs->cfg().size() > rhs->cfg().size();
+    });
+
+    warm_up_pool = new thread_pool_t(thread_count);
+
+    for (module_t* module_ds : modules) {
+        warm_up_pool->submit([module_ds] {
+            if (warm_up_cancelled == false) {
+                module_ds->warm_dominator_sets();
+            }
+        });
+    }
+}
+
+/*! \brief skip the remaining warm-up work and join its threads.
+ */
+void stop_warm_up() {
+    warm_up_cancelled = true;
+
+    delete warm_up_pool;
+    warm_up_pool = nullptr;
+}
+
+void print_status() {
+    uint32_t ready = 0;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        if (it->second->dominators_ready()) {
+            ready += 1;
+        }
+    }
+
+    char message[256];
+    snprintf(message, sizeof(message), "dominators built for %u of %zd "
+            "module(s)", ready, module_map.size());
+
+    util_t::plain(message);
+
+    if (warm_up_pool != nullptr && ready < module_map.size()) {
+        snprintf(message, sizeof(message), ", warming up on %u thread(s)",
+                warm_up_pool->size());
+        util_t::plain(message);
+    }
+
+    util_t::plain(".\n");
+
+    if (query_cache != nullptr) {
+        identifier_t description;
+        query_cache->describe(description);
+
+        util_t::plain(description + ".\n");
+    }
+
+    if (cut_set != nullptr) {
+        snprintf(message, sizeof(message), "cutting %u net(s) matching %zd "
+                "pattern(s).\n", cut_set->matched(), cut_set->size());
+        util_t::plain(message);
+    }
+
+    if (flow_graph != nullptr) {
+        snprintf(message, sizeof(message), "flow graph of %u node(s), "
+                "%.1f MB.\n", flow_graph->size(),
+                flow_graph->bytes() / 1048576.0);
+        util_t::plain(message);
+    }
+
+    if (reach_index != nullptr) {
+        snprintf(message, sizeof(message), "reachability index of %zd "
+                "port(s), %.1f MB.\n", reach_index->size(),
+                reach_index->bytes() / 1048576.0);
+        util_t::plain(message);
+    }
+}
+
+/*! \brief rebuild the modules of the source files that changed.
+ *
+ * Only the changed files are analyzed again, and only their modules are
+ * rebuilt.  The instantiations of these modules elsewhere in the design are
+ * resolved again, and the summaries of the modules that (transitively)
+ * instantiate them are dropped, to be recomputed by the next query that needs
+ * them.  Dominators of the other modules are kept.  A file that fails to
+ * analyze keeps its previous modules and is retried by the next reload.
+ */
+void reload_sources() {
+    if (source_table.size() == 0) {
+        util_t::warn("no source files to reload.\n");
+        return;
+    }
+
+    time_point_t reload_start = std::chrono::steady_clock::now();
+
+    name_list_t changed;
+    source_table.changed_files(changed);
+
+    if (changed.size() == 0) {
+        util_t::plain("no source file changed.\n");
+        return;
+    }
+
+    // Verific replaces the modules of every file that it analyzes, so the
+    // files that succeed are rebuilt even if others fail.
+    name_list_t analyzed;
+
+    for (identifier_t& filename : changed) {
+        if (veri_file::Analyze(filename.c_str(),
+                    veri_file::SYSTEM_VERILOG) == false) {
+            util_t::warn("failed to analyze '" + filename + "', keeping its "
+                    "previous modules.\n");
+            continue;
+        }
+
+        analyzed.push_back(filename);
+    }
+
+    if (analyzed.size() == 0) {
+        return;
+    }
+
+    changed.swap(analyzed);
+
+    // Background threads may be building dominators of the stale modules.
+    uint32_t warm_up_threads = warm_up_pool != nullptr ? warm_up_pool->size() :
+        0;
+    stop_warm_up();
+
+    std::set<identifier_t> changed_files(changed.begin(), changed.end());
+    std::vector<VeriModule*> modules;
+
+    MapIter map_iter;
+    VeriModule* module = nullptr;
+
+    FOREACH_VERILOG_MODULE(map_iter, module) {
+        if (changed_files.find(LineFile::GetFileName(module->Linefile())) !=
+                changed_files.end()) {
+            modules.push_back(module);
+        }
+    }
+
+    // Modules of the changed files, before and after the change.
+    std::set<identifier_t> stale;
+
+    for (identifier_t& filename : changed) {
+        name_list_t& names = source_table.modules(filename);
+        stale.insert(names.begin(), names.end());
+    }
+
+    for (VeriModule* module : modules) {
+        stale.insert(module->GetName());
+    }
+
+    if (summary_table != nullptr) {
+        summary_table->invalidate(stale);
+    }
+
+    if (query_cache != nullptr) {
+        query_cache->invalidate();
+    }
+
+    // The graph and the index refer to the stale modules; they are built
+    // again below.
+    bool rebuild_graph = flow_graph != nullptr;
+    bool rebuild_index = reach_index != nullptr;
+
+    delete reach_index;
+    reach_index = nullptr;
+
+    delete flow_graph;
+    flow_graph = nullptr;
+
+    // Detach the instances of stale modules from the rest of the design.
+    typedef std::pair<module_t*, invoke_t*> instance_t;
+    std::vector<instance_t> instances;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        if (stale.find(it->first) != stale.end()) {
+            continue;
+        }
+
+        for (invoke_t* invoke : it->second->invokes()) {
+            if (stale.find(invoke->module_name()) != stale.end()) {
+                it->second->unlink_invoke(invoke, nullptr);
+                instances.push_back(instance_t(it->second, invoke));
+            }
+        }
+    }
+
+    for (const identifier_t& name : stale) {
+        module_map_t::iterator it = module_map.find(name);
+
+        if (it == module_map.end()) {
+            continue;
+        }
+
+        for (invoke_t* invoke : it->second->invokes()) {
+            module_map_t::iterator callee = module_map.find(
+                    invoke->module_name());
+
+            if (callee != module_map.end() &&
+                    stale.find(callee->first) == stale.end()) {
+                it->second->unlink_invoke(invoke, callee->second);
+            }
+        }
+
+        delete it->second;
+        module_map.erase(it);
+    }
+
+    for (identifier_t& filename : changed) {
+        source_table.add_file(filename);
+        source_table.clear_modules(filename);
+    }
+
+    std::vector<module_t*> rebuilt;
+
+    for (VeriModule* module : modules) {
+        module_t* module_ds = new module_t(module);
+
+        if (module_map.emplace(module_ds->name(), module_ds).second == false) {
+            delete module_ds;
+            continue;
+        }
+
+        source_table.add_module(LineFile::GetFileName(module->Linefile()),
+                module_ds->name());
+        rebuilt.push_back(module_ds);
+    }
+
+    for (module_t* module_ds : rebuilt) {
+        module_ds->resolve_links(module_map);
+        module_ds->build_def_use_chains();
+    }
+
+    for (instance_t& instance : instances) {
+        identifier_t name = instance.second->module_name();
+
+        if (module_map.find(name) == module_map.end()) {
+            util_t::warn("module '" + name + "' instantiated in '" +
+                    instance.first->name() + "' no longer exists.\n");
+            continue;
+        }
+
+        instance.first->relink_invoke(instance.second, module_map);
+    }
+
+    if (summary_table != nullptr) {
+        summary_table->prepare();
+    }
+
+    if (cut_set != nullptr) {
+        cut_set->resolve(module_map);
+    }
+
+    if (rebuild_graph) {
+        flow_graph = build_flow_graph(nullptr);
+    }
+
+    if (rebuild_index) {
+        build_reach_index(1);
+    }
+
+    char message[256];
+    snprintf(message, sizeof(message), "reloaded %zd file(s), rebuilt %zd "
+            "module(s), resolved %zd instance(s) again.\n", changed.size(),
+            rebuilt.size(), instances.size());
+    util_t::plain(message);
+
+    report_time("reload", reload_start);
+
+    if (warm_up_threads > 0) {
+        warm_up_cancelled = false;
+        start_warm_up(warm_up_threads);
+    }
+}
+
+void do_repl() {
+    char* buffer = nullptr;
+    while ((buffer = readline(">> ")) != nullptr) {
+        if (strlen(buffer) == 0) {
+            continue;
+        } else if (strcmp(buffer, "status") == 0) {
+            add_history(buffer);
+            print_status();
+            free(buffer);
+        } else if (strcmp(buffer, "reload") == 0) {
+            add_history(buffer);
+            reload_sources();
+            free(buffer);
+        } else if (strncmp(buffer, "reach ", 6) == 0) {
+            add_history(buffer);
+            process_reach(buffer + 6);
+            free(buffer);
+        } else if (strncmp(buffer, "flows ", 6) == 0) {
+            add_history(buffer);
+            process_flows(buffer + 6);
+            free(buffer);
+        } else if (strncmp(buffer, "pair ", 5) == 0) {
+            add_history(buffer);
+            process_pair(buffer + 5);
+            free(buffer);
+        } else if (strcmp(buffer, "quit") != 0) {
+            add_history(buffer);
+            process_text(buffer);
+            free(buffer);
+        } else {
+            free(buffer);
+            break;
+        }
+    }
+}
+
+/*! \brief JSON result of a query, as printed for every signal of a spec.
+ */
+Json::Value signal_result(std::string mod, std::string fld,
+        id_set_t& timing_ids, id_set_t& non_timing_ids) {
+    Json::Value result;
+
+    if (timing_ids.size() > 0 || non_timing_ids.size() > 0) {
+        name_list_t timing_deps, non_timing_deps;
+
+        util_t::sorted_names(timing_ids, timing_deps);
+        util_t::sorted_names(non_timing_ids, non_timing_deps);
+
+        int idx = 0;
+        for (auto id : timing_deps) {
+            result["timing"][idx] = id;
+            idx++;
+        }
+
+        idx = 0;
+        for (auto id : non_timing_deps) {
+            result["non_timing"][idx] = id;
+            idx++;
+        }
+        result["module"] = mod;
+        result["field"]  = fld;
+        return result;
+    } else {
+        result["module"] = mod;
+        result["field"]  = fld;
+        result["non_timing"] = Json::Value(Json::arrayValue);
+        result["timing"] = Json::Value(Json::arrayValue);
+        return result;
+    }
+}
+
+Json::Value do_one_signal(std::string mod, std::string fld,
+        query_limits_t limits, cut_set_t* cuts) {
+    query_budget_t budget(limits.milliseconds, limits.pops, limits.megabytes);
+
+    dep_analysis_t dep_analysis;
+    dep_analysis.use_summaries(summary_table);
+    dep_analysis.use_cache(query_cache);
+    dep_analysis.use_separate_channels(separate_channels);
+    dep_analysis.use_graph(flow_graph);
+    dep_analysis.use_cuts(cuts);
+    dep_analysis.use_cycle_bound(limits.cycles);
+
+    if (limited(limits)) {
+        dep_analysis.use_budget(&budget);
+    }
+
+    time_point_t start = std::chrono::steady_clock::now();
+    dep_analysis.compute_dependencies(mod, fld, module_map);
+    report_query_time(mod + "." + fld, start, dep_analysis);
+
+    Json::Value result = signal_result(mod, fld,
+            dep_analysis.leaking_timing_deps(),
+            dep_analysis.leaking_non_timing_deps());
+
+    if (bounded(limits)) {
+        result["max_cycles"] = limits.cycles;
+    }
+
+    if (limited(limits)) {
+        add_truncation(result, budget);
+    }
+
+    return result;
+}
+
+/*! \brief answer the signals at 'indices' with a single traversal.
+ */
+void do_signal_pass(std::vector<std::pair<std::string, std::string> >& signals,
+        std::vector<size_t>& indices, std::vector<Json::Value>& results,
+        cut_set_t* cuts) {
+    multi_dep_analysis_t multi_analysis;
+    multi_analysis.use_cache(query_cache);
+    multi_analysis.use_cuts(cuts);
+
+    for (size_t idx : indices) {
+        multi_analysis.add_query(signals[idx].first, signals[idx].second,
+                module_map);
+    }
+
+    time_point_t start = std::chrono::steady_clock::now();
+    multi_analysis.compute_dependencies(module_map);
+
+    uint64_t separate_instrs = 0;
+
+    for (size_t pos = 0; pos < indices.size(); pos++) {
+        std::pair<std::string, std::string>& signal = signals[indices[pos]];
+
+        id_set_t& timing_deps = multi_analysis.leaking_timing_deps(pos);
+        id_set_t& non_timing_deps = multi_analysis.leaking_non_timing_deps(pos);
+
+        results[indices[pos]] = signal_result(signal.first, signal.second,
+                timing_deps, non_timing_deps);
+        separate_instrs += multi_analysis.visited_instrs(pos);
+
+        if (query_cache != nullptr && cuts == nullptr) {
+            // add_query() has checked that the module exists; passes run
+            // in parallel, so the map must not be modified here.
+            module_t* module_ds = module_map.find(signal.first)->second;
+            query_cache_t::result_t result = { timing_deps, non_timing_deps };
+
+            query_cache->add_result(module_ds, symtab_t::intern(signal.second),
+                    query_cache_t::MODE_FULL, result,
+                    query_cache->generation());
+        }
+    }
+
+    if (report_timing) {
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        char message[256];
+        snprintf(message, sizeof(message), "[time] pass of %zd signal(s): "
+                "%.3f ms, %lu instruction(s), %lu if run separately\n",
+                indices.size(), elapsed.count(),
+                multi_analysis.visited_instrs(), separate_instrs);
+
+        util_t::plain(message);
+    }
+}
+
+/*! \brief answer the signals of a spec in passes of up to 'signals_per_pass'
+ * signals each (see multi_dep_analysis_t).
+ *
+ * Duplicate signals, e.g. from overlapping wildcards, and signals that are
+ * in the query cache are not traced again.  Results with cuts are neither
+ * looked up in nor added to the cache.
+ */
+void do_signal_passes(std::vector<std::pair<std::string, std::string> >&
+        signals, std::vector<size_t>& indices,
+        std::vector<Json::Value>& results, cut_set_t* cuts) {
+    std::map<std::pair<std::string, std::string>, size_t> first_index;
+    std::vector<size_t> pending, duplicates;
+
+    for (size_t idx : indices) {
+        if (first_index.emplace(signals[idx], idx).second == false) {
+            duplicates.push_back(idx);
+            continue;
+        }
+
+        query_cache_t::result_t result;
+        module_map_t::iterator it = module_map.find(signals[idx].first);
+
+        if (query_cache != nullptr && cuts == nullptr &&
+                it != module_map.end() &&
+                query_cache->find_result(it->second,
+                    symtab_t::intern(signals[idx].second),
+                    query_cache_t::MODE_FULL, result)) {
+            results[idx] = signal_result(signals[idx].first,
+                    signals[idx].second, result.timing_deps,
+                    result.non_timing_deps);
+            continue;
+        }
+
+        pending.push_back(idx);
+    }
+
+    std::vector<std::vector<size_t> > passes;
+
+    for (size_t pos = 0; pos < pending.size(); pos += signals_per_pass) {
+        size_t end = std::min(pending.size(), pos + signals_per_pass);
+        passes.push_back(std::vector<size_t>(pending.begin() + pos,
+                    pending.begin() + end));
+    }
+
+    if (thread_count > 1) {
+        thread_pool_t pool(thread_count);
+
+        util_t::show_status = false;
+        pool.parallel_for(passes.size(), [&signals, &passes, &results,
+                cuts](size_t idx) {
+            do_signal_pass(signals, passes[idx], results, cuts);
+        });
+        util_t::show_status = true;
+    } else {
+        for (std::vector<size_t>& pass : passes) {
+            do_signal_pass(signals, pass, results, cuts);
+        }
+    }
+
+    for (size_t idx : duplicates) {
+        results[idx] = results[first_index[signals[idx]]];
+    }
+}
+
+/*! \brief trace where a signal flows (see the "flows" section of a spec).
+ */
+Json::Value do_one_flow(std::string mod, std::string fld,
+        query_limits_t limits, cut_set_t* cuts) {
+    query_budget_t budget(limits.milliseconds, limits.pops, limits.megabytes);
+
+    forward_analysis_t forward_analysis;
+    forward_analysis.use_graph(flow_graph);
+    forward_analysis.use_cuts(cuts);
+    forward_analysis.use_cycle_bound(limits.cycles);
+
+    if (limited(limits)) {
+        forward_analysis.use_budget(&budget);
+    }
+
+    time_point_t start = std::chrono::steady_clock::now();
+    forward_analysis.compute_flows(mod, fld, module_map);
+    report_time("flows of " + mod + "." + fld, start);
+
+    Json::Value result = signal_result(mod, fld,
+            forward_analysis.timing_sinks(),
+            forward_analysis.non_timing_sinks());
+    result["direction"] = "forward";
+
+    if (bounded(limits)) {
+        result["max_cycles"] = limits.cycles;
+    }
+
+    if (limited(limits)) {
+        add_truncation(result, budget);
+    }
+
+    return result;
+}
+
+/*! \brief check whether a source leaks into a sink (see the "pairs" section
+ * of a spec).
+ */
+Json::Value do_one_pair(const Json::Value& source, const Json::Value& sink,
+        query_limits_t limits, cut_set_t* cuts) {
+    query_budget_t budget(limits.milliseconds, limits.pops, limits.megabytes);
+
+    pair_analysis_t pair_analysis;
+    pair_analysis.use_graph(flow_graph);
+    pair_analysis.use_index(reach_index);
+    pair_analysis.use_cuts(cuts);
+
+    if (limited(limits)) {
+        pair_analysis.use_budget(&budget);
+    }
+
+    std::string source_mod = source["module"].asString();
+    std::string source_field = source["field"].asString();
+    std::string sink_mod = sink["module"].asString();
+    std::string sink_field = sink["field"].asString();
+
+    time_point_t start = std::chrono::steady_clock::now();
+    pair_analysis.compute_pair(source_mod, source_field, sink_mod, sink_field,
+            module_map);
+    report_time("pair " + source_mod + "." + source_field + " -> " +
+            sink_mod + "." + sink_field, start);
+
+    state_t leaks = pair_analysis.leak_types();
+
+    Json::Value result;
+    result["source"] = source;
+    result["sink"] = sink;
+    result["timing"] = (leaks & DEP_TIMING) != 0;
+    result["non_timing"] = (leaks & DEP_ORDINARY) != 0;
+
+    if (limited(limits)) {
+        add_truncation(result, budget);
+    }
+
+    return result;
+}
+
+/*! \brief expand the (module, field) entries of a spec section, where a
+ * field ending in '*' stands for all ports with that (lowercase) prefix.
+ */
+void expand_signals(Json::Value& entries,
+        std::vector<std::pair<std::string, std::string> >& signals,
+        std::vector<query_limits_t>& limits) {
+    for (auto s : entries) {
+        std::string mod = s["module"].asString().c_str();
+        std::string fld = s["field"].asString().c_str();
+        std::vector<std::string> fields;
+        if (fld.back() == '*') {
+            fld.pop_back();
+
+            module_map_t::iterator it = module_map.find(mod);
+            module_t* module_ds = it->second;
+
+            name_list_t ports;
+            util_t::sorted_names(module_ds->ports(), ports);
+
+            for (identifier_t port : ports) {
+                identifier_t lcase_port = port;
+                std::transform(lcase_port.begin(), lcase_port.end(),
+                               lcase_port.begin(), ::tolower);
+
+                if (lcase_port.size() >= fld.size() &&
+                    lcase_port.compare(0, fld.size(), fld) == 0) {
+                    fields.push_back(port);
+                }
+            }
+        } else {
+            fields.push_back(fld);
+        }
+
+        for (auto fld : fields) {
+            signals.push_back(std::make_pair(mod, fld));
+            limits.push_back(entry_limits(s));
+        }
+    }
+}
+
+Json::Value processJSON(Json::Value root) {
+    Json::Value out(Json::arrayValue);
+    std::vector<std::pair<std::string, std::string> > signals, flows;
+    std::vector<query_limits_t> signal_limits, flow_limits;
+
+    expand_signals(root["signals"], signals, signal_limits);
+    expand_signals(root["flows"], flows, flow_limits);
+
+    // The "cut" section extends the nets of --cut for this spec; an entry
+    // without a module applies to every module.
+    cut_set_t spec_cuts;
+    cut_set_t* cuts = cut_set;
+
+    if (root["cut"].size() > 0) {
+        if (cut_set != nullptr) {
+            spec_cuts = *cut_set;
+        }
+
+        for (auto c : root["cut"]) {
+            spec_cuts.add(c["module"].asString(), c["field"].asString());
+        }
+
+        spec_cuts.resolve(module_map);
+        cuts = &spec_cuts;
+    }
+
+    // Queries only read the module map, so they can run concurrently; the
+    // results are collected by index to keep the order of the serial mode.
+    std::vector<Json::Value> results(signals.size());
+
+    // Passes can neither stop nor bound a single signal, so limited and
+    // bounded signals run alone.
+    std::vector<size_t> pass_indices, single_indices;
+    bool use_passes = summary_table == nullptr && signals_per_pass > 1 &&
+        separate_channels == false;
+
+    for (size_t idx = 0; idx < signals.size(); idx++) {
+        if (use_passes && limited(signal_limits[idx]) == false &&
+                bounded(signal_limits[idx]) == false) {
+            pass_indices.push_back(idx);
+        } else {
+            single_indices.push_back(idx);
+        }
+    }
+
+    if (pass_indices.size() > 0) {
+        do_signal_passes(signals, pass_indices, results, cuts);
+    }
+
+    if (thread_count > 1 && single_indices.size() > 1) {
+        thread_pool_t pool(thread_count);
+
+        util_t::show_status = false;
+        pool.parallel_for(single_indices.size(), [&signals, &signal_limits,
+                &single_indices, &results, cuts](size_t pos) {
+            size_t idx = single_indices[pos];
+
+            results[idx] = do_one_signal(signals[idx].first,
+                    signals[idx].second, signal_limits[idx], cuts);
+        });
+        util_t::show_status = true;
+    } else {
+        for (size_t idx : single_indices) {
+            results[idx] = do_one_signal(signals[idx].first,
+                    signals[idx].second, signal_limits[idx], cuts);
+        }
+    }
+
+    // Forward queries are answered after the signals, in the same way.
+    size_t first_flow = results.size();
+    results.resize(first_flow + flows.size());
+
+    if (thread_count > 1 && flows.size() > 1) {
+        thread_pool_t pool(thread_count);
+
+        util_t::show_status = false;
+        pool.parallel_for(flows.size(), [&flows, &flow_limits, &results,
+                first_flow, cuts](size_t idx) {
+            results[first_flow + idx] = do_one_flow(flows[idx].first,
+                    flows[idx].second, flow_limits[idx], cuts);
+        });
+        util_t::show_status = true;
+    } else {
+        for (size_t idx = 0; idx < flows.size(); idx++) {
+            results[first_flow + idx] = do_one_flow(flows[idx].first,
+                    flows[idx].second, flow_limits[idx], cuts);
+        }
+    }
+
+    // Pairs come last; they run on the flow graph, compiled here if needed.
+    std::vector<Json::Value> pairs;
+    std::vector<query_limits_t> pair_limits;
+
+    for (auto p : root["pairs"]) {
+        pairs.push_back(p);
+        pair_limits.push_back(entry_limits(p));
+    }
+
+    size_t first_pair = results.size();
+    results.resize(first_pair + pairs.size());
+
+    if (pairs.size() > 0) {
+        require_flow_graph();
+    }
+
+    if (thread_count > 1 && pairs.size() > 1) {
+        thread_pool_t pool(thread_count);
+
+        util_t::show_status = false;
+        pool.parallel_for(pairs.size(), [&pairs, &pair_limits, &results,
+                first_pair, cuts](size_t idx) {
+            const Json::Value& entry = pairs[idx];
+
+            results[first_pair + idx] = do_one_pair(entry["source"],
+                    entry["sink"], pair_limits[idx], cuts);
+        });
+        util_t::show_status = true;
+    } else {
+        for (size_t idx = 0; idx < pairs.size(); idx++) {
+            const Json::Value& entry = pairs[idx];
+
+            results[first_pair + idx] = do_one_pair(entry["source"],
+                    entry["sink"], pair_limits[idx], cuts);
+        }
+    }
+
+    for (size_t idx = 0; idx < results.size(); idx++) {
+        out[(int) idx] = results[idx];
+    }
+
+    return out;
+}
+
+bool check_dominators() {
+    uint32_t mismatches = 0;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        module_t* module_ds = it->second;
+
+        if (module_ds->check_dominator_sets() == false) {
+            mismatches += 1;
+        }
+    }
+
+    util_t::clear_status();
+
+    char message[128];
+    snprintf(message, sizeof(message), "checked dominators of %zd module(s), "
+            "%u mismatch(es).\n", module_map.size(), mismatches);
+
+    if (mismatches > 0) {
+        util_t::warn(message);
+    } else {
+        util_t::plain(message);
+    }
+
+    return mismatches == 0;
+}
+
+/*! \brief check that the reachability index lists every leak that a query
+ * of each port reports.
+ */
+bool check_index() {
+    uint32_t port_count = 0;
+    uint32_t mismatches = 0;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        module_t* module_ds = it->second;
+
+        for (symbol_t port : module_ds->ports()) {
+            const identifier_t& field = symtab_t::name(port);
+
+            dep_analysis_t dep_analysis;
+            dep_analysis.compute_dependencies(it->first, field, module_map);
+
+            id_set_t& query_timing = dep_analysis.leaking_timing_deps();
+            id_set_t& query_non_timing = dep_analysis.leaking_non_timing_deps();
+            id_set_t timing_deps, non_timing_deps;
+
+            port_count += 1;
+
+            if (reach_index->trace(module_ds, port, timing_deps,
+                        non_timing_deps) == false ||
+                    std::includes(timing_deps.begin(), timing_deps.end(),
+                        query_timing.begin(), query_timing.end()) == false ||
+                    std::includes(non_timing_deps.begin(),
+                        non_timing_deps.end(), query_non_timing.begin(),
+                        query_non_timing.end()) == false) {
+                util_t::warn("the index misses leaks into '" + it->first +
+                        "." + field + "'.\n");
+                mismatches += 1;
+            }
+        }
+    }
+
+    util_t::clear_status();
+
+    char message[128];
+    snprintf(message, sizeof(message), "checked the index on %u port(s), "
+            "%u mismatch(es).\n", port_count, mismatches);
+
+    if (mismatches > 0) {
+        util_t::warn(message);
+    } else {
+        util_t::plain(message);
+    }
+
+    return mismatches == 0;
+}
+
+/*! \brief check that pair queries between ports agree with the forward query
+ * of the source, with and without the reachability index.
+ *
+ * The sinks of a source port are the ports of its module and the ports that
+ * the forward query reports, so that the check does not grow with the square
+ * of the design.
+ */
+bool check_pairs() {
+    typedef std::pair<module_t*, symbol_t> port_t;
+    std::map<symbol_t, port_t> qualified_ports;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        for (symbol_t port : it->second->ports()) {
+            qualified_ports[it->second->qualified_port(port)] =
+                port_t(it->second, port);
+        }
+    }
+
+    uint64_t pair_count = 0;
+    uint32_t mismatches = 0;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        module_t* module_ds = it->second;
+
+        for (symbol_t port : module_ds->ports()) {
+            const identifier_t& field = symtab_t::name(port);
+
+            forward_analysis_t forward_analysis;
+            forward_analysis.use_graph(flow_graph);
+            forward_analysis.compute_flows(it->first, field, module_map);
+
+            id_set_t& timing_sinks = forward_analysis.timing_sinks();
+            id_set_t& non_timing_sinks = forward_analysis.non_timing_sinks();
+            id_set_t sinks(timing_sinks);
+
+            sinks.insert(non_timing_sinks.begin(), non_timing_sinks.end());
+
+            for (symbol_t own_port : module_ds->ports()) {
+                sinks.insert(module_ds->qualified_port(own_port));
+            }
+
+            for (symbol_t sink : sinks) {
+                auto found = qualified_ports.find(sink);
+                assert(found != qualified_ports.end() && "unknown sink port!");
+
+                port_t& sink_port = found->second;
+                state_t expected = 0;
+
+                if (timing_sinks.find(sink) != timing_sinks.end()) {
+                    expected |= DEP_TIMING;
+                }
+
+                if (non_timing_sinks.find(sink) != non_timing_sinks.end()) {
+                    expected |= DEP_ORDINARY;
+                }
+
+                pair_analysis_t searched, indexed;
+                searched.use_graph(flow_graph);
+                indexed.use_graph(flow_graph);
+                indexed.use_index(reach_index);
+
+                searched.compute_pair(it->first, field,
+                        sink_port.first->name(),
+                        symtab_t::name(sink_port.second), module_map);
+                indexed.compute_pair(it->first, field,
+                        sink_port.first->name(),
+                        symtab_t::name(sink_port.second), module_map);
+
+                pair_count += 1;
+
+                if (searched.leak_types() != expected ||
+                        indexed.leak_types() != expected) {
+                    util_t::warn("pair '" + it->first + "." + field +
+                            "' -> '" + symtab_t::name(sink) +
+                            "' disagrees with the forward query.\n");
+                    mismatches += 1;
+                }
+            }
+        }
+    }
+
+    util_t::clear_status();
+
+    char message[128];
+    snprintf(message, sizeof(message), "checked %lu pair(s) of ports, "
+            "%u mismatch(es).\n", pair_count, mismatches);
+
+    if (mismatches > 0) {
+        util_t::warn(message);
+    } else {
+        util_t::plain(message);
+    }
+
+    return mismatches == 0;
+}
+
+/*! \brief parse the value of a --*threads option ("auto" or a count).
+ */
+bool parse_thread_count(const char* value, uint32_t minimum,
+        uint32_t& thread_count) {
+    if (strcmp(value, "auto") == 0) {
+        thread_count = thread_pool_t::default_size();
+        return true;
+    }
+
+    char* end = nullptr;
+    long count = strtol(value, &end, 10);
+
+    if (end == value || *end != '\0' || count < minimum || count > 1024) {
+        std::cerr << "invalid thread count: " << value << "\n";
+        return false;
+    }
+
+    thread_count = count;
+    return true;
+}
+
+/*! \brief parse the value of a --max-query-* option.
+ */
+bool parse_limit(const char* value, uint64_t& limit) {
+    char* end = nullptr;
+    long long count = strtoll(value, &end, 10);
+
+    if (end == value || *end != '\0' || count < 0) {
+        std::cerr << "invalid query limit: " << value << "\n";
+        return false;
+    }
+
+    limit = count;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool interactive = true;
+    bool check_mode = false;
+    bool check_index_mode = false;
+    bool check_pairs_mode = false;
+    bool summary_mode = false;
+    bool build_graph = false;
+    bool build_index = false;
+    uint32_t load_thread_count = 1;
+    uint32_t warm_up_thread_count = thread_pool_t::default_size();
+    uint32_t cache_megabytes = 256;
+    std::string load_snapshot, save_snapshot;
+    std::vector<std::string> sourceFiles;
+    Json::Value root;
+
+    int first_arg = 1;
+
+    for (; first_arg < argc && strncmp(argv[first_arg], "--", 2) == 0;
+            first_arg++) {
+        if (strcmp(argv[first_arg], "--check-dominators") == 0) {
+            check_mode = true;
+        } else if (strcmp(argv[first_arg], "--check-index") == 0) {
+            check_index_mode = true;
+            build_index = true;
+        } else if (strcmp(argv[first_arg], "--check-pairs") == 0) {
+            check_pairs_mode = true;
+            build_graph = true;
+            build_index = true;
+        } else if (strcmp(argv[first_arg], "--time") == 0) {
+            report_timing = true;
+        } else if (strcmp(argv[first_arg], "--summaries") == 0) {
+            summary_mode = true;
+        } else if (strncmp(argv[first_arg], "--threads=", 10) == 0) {
+            if (parse_thread_count(argv[first_arg] + 10, 1,
+                        thread_count) == false) {
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--load-threads=", 15) == 0) {
+            if (parse_thread_count(argv[first_arg] + 15, 1,
+                        load_thread_count) == false) {
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--warm-up-threads=", 18) == 0) {
+            if (parse_thread_count(argv[first_arg] + 18, 0,
+                        warm_up_thread_count) == false) {
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--signals-per-pass=", 19) == 0) {
+            char* end = nullptr;
+            long count = strtol(argv[first_arg] + 19, &end, 10);
+
+            if (end == argv[first_arg] + 19 || *end != '\0' || count < 1 ||
+                    count > multi_dep_analysis_t::k_max_queries) {
+                std::cerr << "invalid signal count: " << argv[first_arg] + 19
+                    << "\n";
+                return 1;
+            }
+
+            signals_per_pass = count;
+        } else if (strcmp(argv[first_arg], "--flow-graph") == 0) {
+            build_graph = true;
+        } else if (strcmp(argv[first_arg], "--build-index") == 0) {
+            build_index = true;
+        } else if (strcmp(argv[first_arg], "--separate-channels") == 0) {
+            separate_channels = true;
+        } else if (strncmp(argv[first_arg], "--max-query-ms=", 15) == 0) {
+            if (parse_limit(argv[first_arg] + 15,
+                        query_limits.milliseconds) == false) {
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--max-query-pops=", 17) == 0) {
+            if (parse_limit(argv[first_arg] + 17, query_limits.pops) ==
+                    false) {
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--max-query-mb=", 15) == 0) {
+            if (parse_limit(argv[first_arg] + 15, query_limits.megabytes) ==
+                    false) {
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--max-cycles=", 13) == 0) {
+            uint64_t cycles = 0;
+
+            if (parse_limit(argv[first_arg] + 13, cycles) == false) {
+                return 1;
+            }
+
+            query_limits.cycles = std::min<uint64_t>(cycles,
+                    util_t::k_no_index - 1);
+        } else if (strncmp(argv[first_arg], "--cut=", 6) == 0) {
+            if (cut_set == nullptr) {
+                cut_set = new cut_set_t();
+            }
+
+            if (cut_set->parse(argv[first_arg] + 6) == false) {
+                std::cerr << "invalid cut list: " << argv[first_arg] + 6 <<
+                    "\n";
+                return 1;
+            }
+        } else if (strncmp(argv[first_arg], "--cache-mb=", 11) == 0) {
+            char* end = nullptr;
+            long megabytes = strtol(argv[first_arg] + 11, &end, 10);
+
+            if (end == argv[first_arg] + 11 || *end != '\0' || megabytes < 0 ||
+                    megabytes > (1 << 20)) {
+                std::cerr << "invalid cache size: " << argv[first_arg] + 11 <<
+                    "\n";
+                return 1;
+            }
+
+            cache_megabytes = megabytes;
+        } else if (strncmp(argv[first_arg], "--load-snapshot=", 16) == 0) {
+            load_snapshot = argv[first_arg] + 16;
+        } else if (strncmp(argv[first_arg], "--save-snapshot=", 16) == 0) {
+            save_snapshot = argv[first_arg] + 16;
+        } else {
+            std::cerr << "unknown option: " << argv[first_arg] << "\n";
+            return 1;
+        }
+    }
+
+    if (load_snapshot.size() > 0 && argc - first_arg > 1) {
+        std::cerr << "--load-snapshot takes at most a JSON spec, whose "
+            "sources are ignored\n";
+        return 1;
+    }
+
+    if (argc - first_arg < 1 && load_snapshot.size() == 0) {
+        std::cout << root;
+        std::cerr << "USAGE: " << argv[0] << " [options] verilog-files\n";
+        std::cerr << "       " << argv[0] << " [options] <JSON spec>\n";
+        std::cerr << "\noptions:\n";
+        std::cerr << "    --check-dominators   compare dominator trees against "
+                "the iterative algorithm\n";
+        std::cerr << "    --check-index        check that the reachability "
+                "index lists every\n";
+        std::cerr << "                         leak that a query of each port "
+                "reports\n";
+        std::cerr << "    --check-pairs        check that pair queries between "
+                "ports agree with\n";
+        std::cerr << "                         forward queries, with and "
+                "without the index\n";
+        std::cerr << "    --time               report design load and per-query "
+                "times, and peak RSS\n";
+        std::cerr << "    --summaries          cross module instances using "
+                "port-to-port summaries;\n";
+        std::cerr << "                         this changes the results, "
+                "since queries never\n";
+        std::cerr << "                         leave the queried module "
+                "through its inputs\n";
+        std::cerr << "    --threads=<n|auto>   run the queries of a JSON spec on "
+                "<n> threads\n";
+        std::cerr << "    --load-threads=<n|auto>\n";
+        std::cerr << "                         link the design on <n> "
+                "threads\n";
+        std::cerr << "    --warm-up-threads=<n|auto>\n";
+        std::cerr << "                         build dominators on <n> background "
+                "threads in the\n";
+        std::cerr << "                         interactive mode (0 disables, "
+                "default: auto)\n";
+        std::cerr << "    --signals-per-pass=<n>\n";
+        std::cerr << "                         trace up to <n> signals of a "
+                "JSON spec at once\n";
+        std::cerr << "                         (1 to 64, default: 64)\n";
+        std::cerr << "    --separate-channels  trace non-timing and timing "
+                "leaks in separate\n";
+        std::cerr << "                         passes (for benchmarking)\n";
+        std::cerr << "    --max-query-ms=<n>   stop each query after <n> ms\n";
+        std::cerr << "    --max-query-pops=<n> stop each query after <n> "
+                "worklist pops\n";
+        std::cerr << "    --max-query-mb=<n>   stop each query once it holds "
+                "<n> MB of pairs\n";
+        std::cerr << "    --max-cycles=<n>     stop each query at paths "
+                "through more than <n>\n";
+        std::cerr << "                         registers\n";
+        std::cerr << "    --cut=<[module.]net,...>\n";
+        std::cerr << "                         report but never expand the "
+                "matching nets, e.g.\n";
+        std::cerr << "                         --cut=CLK,RST_N,mkCPU.reset* "
+                "(case-insensitive)\n";
+        std::cerr << "    --cache-mb=<n>       keep up to <n> MB of query "
+                "results (0 disables,\n";
+        std::cerr << "                         default: 256)\n";
+        std::cerr << "    --flow-graph         compile the value-flow graph of "
+                "the design and\n";
+        std::cerr << "                         answer queries on it\n";
+        std::cerr << "    --build-index        build the reachability index "
+                "of all ports\n";
+        std::cerr << "    --save-snapshot=<file>\n";
+        std::cerr << "                         write the linked design to "
+                "<file>\n";
+        std::cerr << "    --load-snapshot=<file>\n";
+        std::cerr << "                         read the linked design from "
+                "<file> instead of\n";
+        std::cerr << "                         the sources\n";
+        return 1;
+    }
+
+    if (argc - first_arg == 1) {
+        // Try to parse a JSON spec
+        std::ifstream file;
+        file.open(argv[first_arg]);
+        Json::CharReaderBuilder builder;
+        builder["collectComments"] = false;
+        std::string errs;
+        bool ok = Json::parseFromStream(builder, file, &root, &errs);
+        if (ok) {
+            interactive = false;
+            // TODO: Check JSON schema (is that a thing?)
+            for (int i = 0; i < root["sources"].size(); i++) {
+                sourceFiles.push_back(root["sources"][i].asString());
+            }
+        }
+    }
+
+    if (interactive && load_snapshot.size() > 0 && argc - first_arg > 0) {
+        std::cerr << "not a JSON spec: " << argv[first_arg] << "\n";
+        return 1;
+    }
+
+    if (interactive && load_snapshot.size() == 0) {
+        for (int i = first_arg; i < argc; i++) {
+            sourceFiles.push_back(std::string(argv[i]));
+        }
+    }
+
+    Message::SetMessageType("VERI-1482", VERIFIC_IGNORE);
+
+    time_point_t load_start = std::chrono::steady_clock::now();
+
+    if (load_snapshot.size() > 0) {
+        if (snapshot_t::load(load_snapshot, module_map, reach_index) ==
+                false) {
+            destroy_module_map();
+            return 1;
+        }
+    } else {
+        util_t::update_status("analyzing input files ... ");
+
+        for (auto f : sourceFiles) {
+            analyze_file(f.c_str());
+            source_table.add_file(f);
+        }
+
+        report_time("source analysis", load_start);
+
+        thread_pool_t* load_pool = nullptr;
+
+        if (load_thread_count > 1) {
+            load_pool = new thread_pool_t(load_thread_count);
+        }
+
+        time_point_t build_start = std::chrono::steady_clock::now();
+        parse_modules();
+        report_time("module construction", build_start);
+
+        util_t::update_status("building def-use chains ... ");
+
+        time_point_t link_start = std::chrono::steady_clock::now();
+        link_modules(load_pool);
+        report_time("links and def-use chains", link_start);
+
+        delete load_pool;
+        load_pool = nullptr;
+    }
+
+    util_t::clear_status();
+    report_time("design load", load_start);
+    report_memory("design load");
+
+    if (cut_set != nullptr) {
+        cut_set->resolve(module_map);
+    }
+
+    if (build_graph) {
+        thread_pool_t* graph_pool = nullptr;
+
+        if (load_thread_count > 1) {
+            graph_pool = new thread_pool_t(load_thread_count);
+        }
+
+        flow_graph = build_flow_graph(graph_pool);
+        delete graph_pool;
+    }
+
+    if (build_index && reach_index == nullptr) {
+        build_reach_index(load_thread_count);
+    }
+
+    if (save_snapshot.size() > 0) {
+        time_point_t save_start = std::chrono::steady_clock::now();
+
+        if (snapshot_t::save(save_snapshot, module_map, reach_index) ==
+                false) {
+            destroy_module_map();
+            return 1;
+        }
+
+        report_time("snapshot", save_start);
+    }
+
+    rl_attempted_completion_function = complete_text;
+
+    if (check_mode || check_index_mode || check_pairs_mode) {
+        bool success = true;
+
+        if (check_mode) {
+            success = check_dominators() && success;
+        }
+
+        if (check_index_mode) {
+            success = check_index() && success;
+        }
+
+        if (check_pairs_mode) {
+            success = check_pairs() && success;
+        }
+
+        delete reach_index;
+        reach_index = nullptr;
+
+        delete flow_graph;
+        flow_graph = nullptr;
+
+        destroy_module_map();
+        return success ? 0 : 1;
+    }
+
+    // Summaries are computed by the first query that needs them.
+    if (summary_mode) {
+        summary_table = new summary_table_t(module_map);
+        summary_table->prepare();
+    }
+
+    if (cache_megabytes > 0) {
+        query_cache = new query_cache_t((size_t) cache_megabytes << 20);
+    }
+
+    if (interactive) {
+        if (warm_up_thread_count > 0) {
+            start_warm_up(warm_up_thread_count);
+        }
+
+        do_repl();
+        stop_warm_up();
+    } else {
+        time_point_t batch_start = std::chrono::steady_clock::now();
+        Json::Value out = processJSON(root);
+        report_time("all signals", batch_start);
+
+        std::cout << out << std::endl;
+    }
+
+    delete query_cache;
+    query_cache = nullptr;
+
+    delete cut_set;
+    cut_set = nullptr;
+
+    delete summary_table;
+    summary_table = nullptr;
+
+    delete reach_index;
+    reach_index = nullptr;
+
+    delete flow_graph;
+    flow_graph = nullptr;
+
     destroy_module_map();
     return 0 ;
 }
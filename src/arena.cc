@@ -0,0 +1,71 @@
+#include <cassert>
+#include <cstdlib>
+
+#include <stdint.h>
+
+#include "arena.h"
+
+arena_t::arena_t() {
+    cursor = nullptr;
+    limit = nullptr;
+    reserved = 0;
+}
+
+arena_t::~arena_t() {
+    for (auto it = finalizers.rbegin(); it != finalizers.rend(); it++) {
+        it->destructor(it->object);
+    }
+
+    for (char* chunk : chunks) {
+        free(chunk);
+    }
+
+    finalizers.clear();
+    chunks.clear();
+
+    cursor = nullptr;
+    limit = nullptr;
+}
+
+/*! \brief reserve 'size' bytes aligned to 'alignment' (a power of two).
+ */
+void* arena_t::allocate(size_t size, size_t alignment) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(cursor);
+    uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+
+    if (cursor == nullptr ||
+            aligned + size > reinterpret_cast<uintptr_t>(limit)) {
+        // Oversized objects get a chunk of their own.
+        size_t chunk_size = k_chunk_size;
+        if (size + alignment > chunk_size) {
+            chunk_size = size + alignment;
+        }
+
+        char* chunk = static_cast<char*>(malloc(chunk_size));
+        assert(chunk != nullptr && "failed to allocate arena chunk!");
+
+        chunks.push_back(chunk);
+        reserved += chunk_size;
+
+        cursor = chunk;
+        limit = chunk + chunk_size;
+
+        address = reinterpret_cast<uintptr_t>(cursor);
+        aligned = (address + alignment - 1) & ~(alignment - 1);
+    }
+
+    cursor = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+}
+
+/*! \brief count of bytes obtained from the system allocator.
+ */
+size_t arena_t::bytes_reserved() {
+    return reserved;
+}
+
+/*! \brief count of chunks held by the arena.
+ */
+size_t arena_t::chunk_count() {
+    return chunks.size();
+}
@@ -0,0 +1,82 @@
+#include "budget.h"
+
+/*! \brief budget of 'milliseconds' of wall time, 'max_pop_count' pops and
+ * 'megabytes' of reached pairs; zero leaves a resource unlimited.
+ */
+query_budget_t::query_budget_t(uint64_t milliseconds, uint64_t max_pop_count,
+        uint64_t megabytes) {
+    max_milliseconds = milliseconds;
+    max_pops = max_pop_count;
+    max_bytes = megabytes << 20;
+
+    pops = 0;
+    limit = LIMIT_NONE;
+
+    start_time = std::chrono::steady_clock::now();
+}
+
+/*! \brief restart the clock and the count of pops, for a new query.
+ */
+void query_budget_t::start() {
+    start_time = std::chrono::steady_clock::now();
+
+    pops = 0;
+    limit = LIMIT_NONE;
+}
+
+bool query_budget_t::out_of_time() {
+    if (max_milliseconds == 0) {
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+
+    return elapsed.count() > max_milliseconds;
+}
+
+/*! \brief charge one pop of a query that has reached 'pair_count' pairs.
+ *
+ * Returns false if the budget is exhausted, in which case the query should
+ * stop without popping.
+ */
+bool query_budget_t::charge(uint64_t pair_count) {
+    if (limit != LIMIT_NONE) {
+        return false;
+    }
+
+    pops += 1;
+
+    if (max_pops != 0 && pops > max_pops) {
+        limit = LIMIT_POPS;
+    } else if (max_bytes != 0 && pair_count * k_pair_bytes > max_bytes) {
+        limit = LIMIT_MEMORY;
+    } else if (pops % k_time_period == 0 && out_of_time()) {
+        limit = LIMIT_TIME;
+    }
+
+    return limit == LIMIT_NONE;
+}
+
+/*! \brief the limit that stopped the query, or LIMIT_NONE.
+ */
+uint8_t query_budget_t::exhausted_limit() {
+    return limit;
+}
+
+/*! \brief name of a limit, as reported in the JSON output.
+ */
+const char* query_budget_t::limit_name(uint8_t limit) {
+    switch (limit) {
+        case LIMIT_TIME:
+            return "time";
+
+        case LIMIT_POPS:
+            return "pops";
+
+        case LIMIT_MEMORY:
+            return "memory";
+    }
+
+    return "none";
+}
@@ -0,0 +1,178 @@
+#include <cstdio>
+
+#include "cache.h"
+
+// Rough size of a node of an id_set_t, and of an entry of the hash map and
+// the LRU list, on 64-bit hosts.
+static const size_t k_set_node_bytes = 40;
+static const size_t k_entry_bytes = 160;
+
+query_cache_t::query_cache_t(size_t __budget) {
+    budget = __budget;
+    used_bytes = 0;
+    current_generation = 0;
+
+    hit_count = miss_count = 0;
+    result_count = expansion_count = 0;
+}
+
+/*! \brief generation of the design that new entries must belong to.
+ */
+uint64_t query_cache_t::generation() {
+    std::lock_guard<std::mutex> guard(lock);
+    return current_generation;
+}
+
+/*! \brief drop all entries and start a new generation.
+ */
+void query_cache_t::invalidate() {
+    std::lock_guard<std::mutex> guard(lock);
+
+    entries.clear();
+    lru_list.clear();
+
+    used_bytes = 0;
+    result_count = expansion_count = 0;
+    current_generation += 1;
+}
+
+/*! \brief look up an entry and mark it as the most recently used.
+ *
+ * The caller must hold 'lock'.
+ */
+query_cache_t::entry_t* query_cache_t::find(const key_t& key) {
+    entry_map_t::iterator it = entries.find(key);
+
+    if (it == entries.end()) {
+        return nullptr;
+    }
+
+    lru_list.splice(lru_list.begin(), lru_list, it->second.position);
+
+    return &it->second;
+}
+
+/*! \brief add an entry computed during 'generation', then evict entries
+ * until the cache fits its budget again.
+ *
+ * The caller must hold 'lock'.
+ */
+void query_cache_t::insert(const key_t& key, entry_t& entry,
+        uint64_t generation) {
+    if (generation != current_generation || entry.bytes > budget) {
+        return;
+    }
+
+    if (entries.find(key) != entries.end()) {
+        return;
+    }
+
+    lru_list.push_front(key);
+    entry.position = lru_list.begin();
+
+    if (key.kind == ENTRY_RESULT) {
+        result_count += 1;
+    } else {
+        expansion_count += 1;
+    }
+
+    used_bytes += entry.bytes;
+    entries.emplace(key, std::move(entry));
+
+    evict();
+}
+
+void query_cache_t::evict() {
+    while (used_bytes > budget && lru_list.size() > 0) {
+        erase(entries.find(lru_list.back()));
+    }
+}
+
+void query_cache_t::erase(entry_map_t::iterator it) {
+    if (it->first.kind == ENTRY_RESULT) {
+        result_count -= 1;
+    } else {
+        expansion_count -= 1;
+    }
+
+    used_bytes -= it->second.bytes;
+    lru_list.erase(it->second.position);
+    entries.erase(it);
+}
+
+/*! \brief copy the cached result of a query, if there is one.
+ */
+bool query_cache_t::find_result(module_t* module_ds, symbol_t id,
+        uint8_t mode, result_t& result) {
+    key_t key = { ENTRY_RESULT, mode, id, module_ds };
+
+    std::lock_guard<std::mutex> guard(lock);
+    entry_t* entry = find(key);
+
+    if (entry == nullptr) {
+        miss_count += 1;
+        return false;
+    }
+
+    hit_count += 1;
+    result = entry->result;
+    return true;
+}
+
+void query_cache_t::add_result(module_t* module_ds, symbol_t id, uint8_t mode,
+        result_t& result, uint64_t generation) {
+    key_t key = { ENTRY_RESULT, mode, id, module_ds };
+
+    entry_t entry;
+    entry.result = result;
+    entry.bytes = k_entry_bytes + k_set_node_bytes *
+        (result.timing_deps.size() + result.non_timing_deps.size());
+
+    std::lock_guard<std::mutex> guard(lock);
+    insert(key, entry, generation);
+}
+
+/*! \brief cached expansion of a (module, identifier) pair, or nullptr.
+ *
+ * Expansions are shared, so they must not be modified.
+ */
+query_cache_t::expansion_ptr_t query_cache_t::find_expansion(
+        module_t* module_ds, symbol_t id) {
+    key_t key = { ENTRY_EXPANSION, MODE_FULL, id, module_ds };
+
+    std::lock_guard<std::mutex> guard(lock);
+    entry_t* entry = find(key);
+
+    if (entry == nullptr) {
+        return expansion_ptr_t();
+    }
+
+    return entry->expansion;
+}
+
+void query_cache_t::add_expansion(module_t* module_ds, symbol_t id,
+        expansion_ptr_t expansion, uint64_t generation) {
+    key_t key = { ENTRY_EXPANSION, MODE_FULL, id, module_ds };
+
+    entry_t entry;
+    entry.expansion = expansion;
+    entry.bytes = k_entry_bytes + sizeof(dep_analysis_t::expansion_t) +
+        expansion->steps.capacity() * sizeof(dep_analysis_t::step_t);
+
+    std::lock_guard<std::mutex> guard(lock);
+    insert(key, entry, generation);
+}
+
+/*! \brief one-line description of the contents of the cache.
+ */
+void query_cache_t::describe(identifier_t& description) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    char message[256];
+    snprintf(message, sizeof(message), "query cache: %lu result(s), %lu "
+            "expansion(s), %.1f of %.1f MB, %lu hit(s), %lu miss(es)",
+            result_count, expansion_count, used_bytes / (1024.0 * 1024.0),
+            budget / (1024.0 * 1024.0), hit_count, miss_count);
+
+    description = message;
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <sstream>
+
+#include "cut.h"
+
+cut_set_t::cut_set_t() {
+    match_count = 0;
+}
+
+/*! \brief check whether a lowercase name matches a lowercase pattern.
+ */
+bool cut_set_t::matches(const identifier_t& pattern,
+        const identifier_t& name) {
+    if (pattern.size() > 0 && pattern.back() == '*') {
+        size_t length = pattern.size() - 1;
+        return name.size() >= length && name.compare(0, length, pattern, 0,
+                length) == 0;
+    }
+
+    return name == pattern;
+}
+
+/*! \brief cut the nets of 'module' matching 'pattern', or those of every
+ * module if 'module' is empty.
+ */
+void cut_set_t::add(const identifier_t& module, const identifier_t& pattern) {
+    entry_t entry = { module, pattern };
+
+    std::transform(entry.pattern.begin(), entry.pattern.end(),
+            entry.pattern.begin(), ::tolower);
+    entries.push_back(entry);
+}
+
+/*! \brief add a comma-separated list of "[<module>.]<pattern>" entries.
+ *
+ * Returns false if an entry is empty.
+ */
+bool cut_set_t::parse(const std::string& list) {
+    std::stringstream stream(list);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        size_t separator = item.find('.');
+        identifier_t module, pattern = item;
+
+        if (separator != std::string::npos) {
+            module = item.substr(0, separator);
+            pattern = item.substr(separator + 1);
+        }
+
+        if (pattern.size() == 0) {
+            return false;
+        }
+
+        add(module, pattern);
+    }
+
+    return entries.size() > 0;
+}
+
+/*! \brief match the patterns against the symbols of the design.
+ */
+void cut_set_t::resolve(module_map_t& module_map) {
+    global_ids.assign(symtab_t::size(), false);
+    module_ids.clear();
+    match_count = 0;
+
+    std::vector<module_t*> modules;
+
+    for (entry_t& entry : entries) {
+        if (entry.module.size() == 0) {
+            modules.push_back(nullptr);
+            continue;
+        }
+
+        module_map_t::iterator it = module_map.find(entry.module);
+
+        if (it == module_map.end()) {
+            util_t::warn("cut set: no module named '" + entry.module +
+                    "'\n");
+        }
+
+        modules.push_back(it != module_map.end() ? it->second : nullptr);
+    }
+
+    for (symbol_t id = 0; id < global_ids.size(); id++) {
+        identifier_t name = symtab_t::name(id);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        for (size_t idx = 0; idx < entries.size(); idx++) {
+            if (matches(entries[idx].pattern, name) == false) {
+                continue;
+            }
+
+            if (entries[idx].module.size() == 0) {
+                match_count += global_ids[id] ? 0 : 1;
+                global_ids[id] = true;
+            } else if (modules[idx] != nullptr) {
+                match_count += module_ids[modules[idx]].insert(id).second ?
+                    1 : 0;
+            }
+        }
+    }
+}
+
+/*! \brief check whether the set has no patterns.
+ */
+bool cut_set_t::empty() {
+    return entries.size() == 0;
+}
+
+/*! \brief count of patterns.
+ */
+size_t cut_set_t::size() {
+    return entries.size();
+}
+
+/*! \brief count of names matched by the last resolve(), counting a name once
+ * for all modules and once for each module that it is cut in.
+ */
+uint32_t cut_set_t::matched() {
+    return match_count;
+}
+
+/*! \brief check whether an identifier of a module is cut.
+ *
+ * Symbols interned after the last resolve() are never cut.
+ */
+bool cut_set_t::contains(module_t* module_ds, symbol_t id) {
+    if (id < global_ids.size() && global_ids[id]) {
+        return true;
+    }
+
+    if (module_ids.size() == 0) {
+        return false;
+    }
+
+    std::unordered_map<module_t*, id_set_t>::iterator it =
+        module_ids.find(module_ds);
+
+    return it != module_ids.end() && it->second.find(id) != it->second.end();
+}
@@ -1,114 +1,372 @@
+#include "cache.h"
 #include "dependence.h"
 
-void dep_analysis_t::add_new_ids(id_set_t& ids, state_t type,
+dep_analysis_t::dep_analysis_t() {
+    instr_count = 0;
+    summaries = nullptr;
+
+    cache = nullptr;
+    cache_generation = 0;
+    cached_result = false;
+
+    channels = DEP_BOTH;
+    separate_channels = false;
+
+    graph = nullptr;
+
+    budget = nullptr;
+    reached_count = 0;
+
+    cuts = nullptr;
+    root_module = nullptr;
+    root_id = 0;
+
+    cycle_bound = util_t::k_no_index;
+    cycle = 0;
+}
+
+/*! \brief answer queries using module summaries (see summary_table_t).
+ *
+ * Queries then stay within the requested module: instances are crossed using
+ * the summaries of their outputs, and flows are not followed out of the
+ * requested module into the modules that instantiate it.
+ */
+void dep_analysis_t::use_summaries(summary_table_t* __summaries) {
+    summaries = __summaries;
+}
+
+/*! \brief reuse the results and expansions of earlier queries.
+ */
+void dep_analysis_t::use_cache(query_cache_t* __cache) {
+    cache = __cache;
+}
+
+/*! \brief traverse the compiled flow graph instead of expanding the
+ * definitions of every reached identifier.
+ *
+ * The results are identical; identifiers that are not in the graph, and
+ * queries with separate channels, still use the expansions.
+ */
+void dep_analysis_t::use_graph(flow_graph_t* __graph) {
+    graph = __graph;
+}
+
+/*! \brief stop queries once 'budget' is exhausted, with the leaks found so
+ * far (see truncated()).
+ *
+ * Summarized queries are not limited.
+ */
+void dep_analysis_t::use_budget(query_budget_t* __budget) {
+    budget = __budget;
+}
+
+/*! \brief stop queries at the nets of 'cuts' (see cut_set_t).
+ *
+ * Results of queries with cuts are not cached, since they depend on the cut
+ * set; expansions still are.  Summarized queries only cut the nets of the
+ * queried module, since the summaries of its instances are shared.
+ */
+void dep_analysis_t::use_cuts(cut_set_t* __cuts) {
+    cuts = __cuts;
+}
+
+/*! \brief stop queries at paths that cross more than 'cycles' registers,
+ * i.e. definitions in triggered 'always' blocks, or never if 'cycles' is
+ * util_t::k_no_index.  The timing flow from a register to its trigger does
+ * not cross it, since the trigger acts in the same cycle.
+ *
+ * Pairs are reached in passes of increasing register counts, so that each
+ * is reached with the fewest registers on its path.  Bounded queries trace
+ * both channels in one pass and are not cached; summarized queries are not
+ * bounded, since summaries do not count registers.
+ */
+void dep_analysis_t::use_cycle_bound(uint32_t cycles) {
+    cycle_bound = cycles;
+}
+
+/*! \brief trace the non-timing channel first, then the timing channel.
+ *
+ * This only exists to measure the single-pass lattice against two passes;
+ * the second pass starts from the timing dependences of the first and
+ * re-expands every pair that they reach.
+ */
+void dep_analysis_t::use_separate_channels(bool __separate_channels) {
+    separate_channels = __separate_channels;
+}
+
+/*! \brief check whether the last query was answered from the cache.
+ */
+bool dep_analysis_t::from_cache() {
+    return cached_result;
+}
+
+/*! \brief check whether the last query ran out of budget, in which case its
+ * results are partial.
+ */
+bool dep_analysis_t::truncated() {
+    return budget != nullptr &&
+        budget->exhausted_limit() != query_budget_t::LIMIT_NONE;
+}
+
+/*! \brief check whether a pair is cut, i.e. reached but never expanded.
+ */
+bool dep_analysis_t::cut(module_t* module_ds, symbol_t id) {
+    return cuts != nullptr && (module_ds != root_module || id != root_id) &&
+        cuts->contains(module_ds, id);
+}
+
+bool dep_analysis_t::cut_node(uint32_t node_idx) {
+    return cuts != nullptr && cut(graph->module_of(node_idx),
+            graph->id_of(node_idx));
+}
+
+/*! \brief raise the lattice value of a pair by 'type'.
+ *
+ * The pair is (re-)queued only if its value rises, and a port is reported
+ * once for every type that reaches it.  A pair reached for the first time
+ * also taints the instances that it is connected to (see
+ * gather_inter_module_dependencies()).  Cut pairs are reported, but neither
+ * queued nor tainting.
+ */
+void dep_analysis_t::add_new_id(symbol_t id, state_t type,
         module_t* module_ds) {
-    for (identifier_t id : ids) {
-        dependence_t dep = { type, id, module_ds };
-        if (seen_set.find(dep) == seen_set.end()) {
-            if (module_ds->port_exists(id)) {
-                if (type == DEP_TIMING) {
-                    timing_deps.insert(module_ds->name() + "." + id);
-                } else {
-                    non_timing_deps.insert(module_ds->name() + "." + id);
-                }
-            }
+    dependence_t dependence = { type, id, module_ds };
+
+    if ((type & ~channels) != 0) {
+        deferred.push_back(dependence);
+        type &= channels;
+    }
+
+    node_t& node = nodes[module_ds][id];
+    state_t new_type = type & ~node.value;
 
-            dependence_t dependence = { type, id, module_ds };
-            workset.insert(dependence);
-            seen_set.insert(dependence);
+    if (new_type == 0) {
+        return;
+    }
+
+    if (module_ds->port_exists(id)) {
+        if (new_type & DEP_TIMING) {
+            timing_deps.insert(module_ds->qualified_port(id));
+        }
+
+        if (new_type & DEP_ORDINARY) {
+            non_timing_deps.insert(module_ds->qualified_port(id));
         }
     }
-}
 
-void dep_analysis_t::gather_implicit_dependencies(instr_t* instr,
-        state_t& dependence_type) {
-    bb_t* bb = instr->parent();
-    module_t* module_ds = bb->parent();
+    if (cut(module_ds, id)) {
+        reached_count += node.value == 0 ? 1 : 0;
+        node.value |= new_type;
+        return;
+    }
+
+    if (node.pending == 0) {
+        workset.insert(dependence);
+    }
 
-    bb_set_t guard_blocks;
-    module_ds->populate_guard_blocks(bb, guard_blocks);
+    bool first_seen = node.value == 0;
 
-    for (bb_t* guard_block : guard_blocks) {
-        cmpr_t* comparison = guard_block->comparison();
-        assert(comparison != nullptr && "invalid comparison!");
+    node.value |= new_type;
+    node.pending |= new_type;
 
-        add_new_ids(comparison->uses(), dependence_type, module_ds);
+    if (first_seen) {
+        reached_count += 1;
+        taint_connections(module_ds, id);
+    }
+}
+
+void dep_analysis_t::add_new_ids(id_set_t& ids, state_t type,
+        module_t* module_ds) {
+    for (symbol_t id : ids) {
+        add_new_id(id, type, module_ds);
     }
 }
 
-void dep_analysis_t::gather_timing_dependencies(instr_t* instr) {
-    bb_t* bb = instr->parent();
-    bb_t* entry_block = bb->entry_block();
-    module_t* module_ds = entry_block->parent();
+/*! \brief check whether an identifier of a module has been seen already,
+ * so that the ports connected to it are tainted.  Cut identifiers never are.
+ */
+bool dep_analysis_t::seen(module_t* module_ds, symbol_t id) {
+    node_index_t::iterator it = nodes.find(module_ds);
 
-    instr_list_t& instrs = entry_block->instrs();
-    assert(instrs.size() > 0 && "invalid basic block!");
+    if (it == nodes.end()) {
+        return false;
+    }
 
-    instr_list_t::iterator it = instrs.begin();
-    instr_t* first_instr = *it;
+    node_map_t::iterator node_it = it->second.find(id);
+    return node_it != it->second.end() && node_it->second.value != 0 &&
+        cut(module_ds, id) == false;
+}
 
-    trigger_t* trigger = dynamic_cast<trigger_t*>(first_instr);
-    assert(trigger != nullptr && "invalid always block!");
+/*! \brief taint the ports connected to a newly reached identifier, in the
+ * instances that have been expanded already.
+ */
+void dep_analysis_t::taint_connections(module_t* module_ds, symbol_t id) {
+    invoke_index_t::iterator it = invokes.find(module_ds);
 
-    add_new_ids(trigger->trigger_ids(), DEP_TIMING, module_ds);
+    if (it == invokes.end()) {
+        return;
+    }
+
+    for (auto& entry : it->second) {
+        for (conn_t& connection : entry.first->connections()) {
+            if (connection.id_set.find(id) != connection.id_set.end()) {
+                add_new_id(connection.remote_endpoint, entry.second.type,
+                        entry.second.invoked_ds);
+            }
+        }
+    }
 }
 
+/*! \brief taint the ports of an instance whose connections have been reached.
+ *
+ * The instance is remembered with the types it was expanded with, so that
+ * identifiers reached later still taint their ports (see
+ * taint_connections()).  The result thus does not depend on the order in
+ * which pairs are visited.
+ */
 void dep_analysis_t::gather_inter_module_dependencies(invoke_t* invoke,
         state_t dependence_type, module_map_t& module_map) {
     module_map_t::iterator it = module_map.find(invoke->module_name());
     assert(it != module_map.end() && "failed to find invoked module!");
 
     module_t* module_ds = it->second;
-    id_set_t& ports = module_ds->ports();
+    module_t* caller_ds = invoke->parent()->parent();
+
+    invoke_state_t& invoke_state = invokes[caller_ds][invoke];
+    state_t new_type = dependence_type & ~invoke_state.type;
+
+    if (new_type == 0) {
+        return;
+    }
+
+    invoke_state.type |= new_type;
+    invoke_state.invoked_ds = module_ds;
 
     // Find which arguments in the caller are tainted, then
     // transfer taint to the corresponding arguments in the callee.
     id_set_t new_taints;
 
-    for (conn_t connection : invoke->connections()) {
-        for (identifier_t id : connection.id_set) {
-            for (dependence_t dependence : seen_set) {
-                if (dependence.id == id) {
-                    new_taints.insert(connection.remote_endpoint);
-                    break;
-                }
+    for (conn_t& connection : invoke->connections()) {
+        for (symbol_t id : connection.id_set) {
+            if (seen(caller_ds, id)) {
+                new_taints.insert(connection.remote_endpoint);
+                break;
             }
         }
     }
 
-    add_new_ids(new_taints, dependence_type, module_ds);
+    add_new_ids(new_taints, new_type, module_ds);
 }
 
-bool dep_analysis_t::gather_dependencies(instr_t* instr,
-        dependence_t& dependence, module_map_t& module_map) {
-    bool timing_leakage = false;
+/*! \brief record the effects of visiting the definitions of an identifier.
+ *
+ * This only reads the module, so it may run on several threads at once.  The
+ * steps are applied later by apply_expansion(), against the seen set.
+ */
+void dep_analysis_t::expand_dependence(module_t* module_ds, symbol_t id,
+        expansion_t& expansion) {
+    instr_set_t& instr_set = module_ds->def_instrs(id);
 
-    bb_t* bb = instr->parent();
-    bb_t* entry_bb = bb->entry_block();
-    module_t* module_ds = bb->parent();
+    expansion.steps.clear();
+    expansion.instrs = instr_set.size();
 
-    if (invoke_t* invoke = dynamic_cast<invoke_t*>(instr)) {
-        gather_inter_module_dependencies(invoke, dependence.type, module_map);
+    for (instr_t* instr : instr_set) {
+        bb_t* bb = instr->parent();
+        module_t* new_module_ds = bb->parent();
+
+        // We check for redundancy inside the following method.
+        new_module_ds->build_dominator_sets();
+
+        if (instr->kind() == INSTR_INVOKE) {
+            step_t step = { STEP_INVOKE, 0, new_module_ds,
+                static_cast<invoke_t*>(instr), false };
+            expansion.steps.push_back(step);
+        }
+
+        bool registered = new_module_ds->clocked_block(bb);
+
+        // Explicit dependencies.
+        for (symbol_t use : instr->uses()) {
+            step_t step = { STEP_SAME_TYPE, use, new_module_ds, nullptr,
+                registered };
+            expansion.steps.push_back(step);
+        }
+
+        // Implicit dependencies, i.e. the uses of the guarding comparisons.
+        for (symbol_t guard_id : new_module_ds->implicit_flow_ids(bb)) {
+            step_t step = { STEP_IMPLICIT, guard_id, new_module_ds, nullptr,
+                registered };
+            expansion.steps.push_back(step);
+        }
+
+        // Timing dependencies, i.e. the trigger of the 'always' block.  The
+        // trigger affects the registers in the same cycle, so these steps
+        // do not cross a register.
+        if (bb->entry_block()->block_type() == BB_ALWAYS) {
+            for (symbol_t trigger_id : new_module_ds->timing_trigger_ids(bb)) {
+                step_t step = { STEP_TIMING, trigger_id, new_module_ds,
+                    nullptr, false };
+                expansion.steps.push_back(step);
+            }
+        }
     }
+}
+
+void dep_analysis_t::apply_expansion(expansion_t& expansion,
+        dependence_t& dependence, module_map_t& module_map) {
+    for (step_t& step : expansion.steps) {
+        // A bounded query crosses registers in its next pass, if any.
+        if (step.registered && cycle_bound != util_t::k_no_index) {
+            if (cycle < cycle_bound) {
+                dependence_t later = { dependence.type, step.id,
+                    step.module_ds };
+                next_cycle.push_back(later);
+            }
+
+            continue;
+        }
+
+        switch (step.kind) {
+            case STEP_SAME_TYPE:
+            case STEP_IMPLICIT:
+                add_new_id(step.id, dependence.type, step.module_ds);
+                break;
 
-    // Gather explicit dependencies.
-    add_new_ids(instr->uses(), dependence.type, module_ds);
+            case STEP_TIMING:
+                add_new_id(step.id, DEP_TIMING, step.module_ds);
+                break;
 
-    // Gather implicit dependencies.
-    if (module_ds->postdominates(bb, entry_bb) == false) {
-        gather_implicit_dependencies(instr, dependence.type);
+            case STEP_INVOKE:
+                gather_inter_module_dependencies(step.invoke, dependence.type,
+                        module_map);
+                break;
+        }
     }
+}
 
-    // Gather timing dependencies.
-    if (entry_bb->block_type() == BB_ALWAYS) {
-        if (dependence.type == DEP_TIMING) {
-            timing_leakage = true;
+/*! \brief expansion of a dependence, computed now unless it was cached by
+ * an earlier query.
+ */
+dep_analysis_t::expansion_t& dep_analysis_t::find_expansion(
+        dependence_t& dependence) {
+    if (cache != nullptr) {
+        cached_expansion = cache->find_expansion(dependence.module_ds,
+                dependence.id);
+
+        if (cached_expansion == nullptr) {
+            cached_expansion = std::make_shared<expansion_t>();
+            expand_dependence(dependence.module_ds, dependence.id,
+                    *cached_expansion);
+
+            cache->add_expansion(dependence.module_ds, dependence.id,
+                    cached_expansion, cache_generation);
         }
 
-        gather_timing_dependencies(instr);
+        return *cached_expansion;
     }
 
-    return timing_leakage;
+    expand_dependence(dependence.module_ds, dependence.id, scratch);
+    return scratch;
 }
 
 /*! \brief analyze the requested fieldname for leakage.
@@ -116,11 +374,24 @@ bool dep_analysis_t::gather_dependencies(instr_t* instr,
 bool dep_analysis_t::compute_dependencies(identifier_t module_name,
         identifier_t identifier, module_map_t& module_map) {
     workset.clear();
-    seen_set.clear();
+    nodes.clear();
+    invokes.clear();
+    deferred.clear();
 
     timing_deps.clear();
     non_timing_deps.clear();
 
+    instr_count = 0;
+    reached_count = 0;
+
+    cycle = 0;
+    next_cycle.clear();
+    graph_next_cycle.clear();
+
+    if (budget != nullptr) {
+        budget->start();
+    }
+
     module_map_t::iterator it = module_map.find(module_name);
     assert(it != module_map.end() && "failed to find requested module!");
 
@@ -128,39 +399,316 @@ bool dep_analysis_t::compute_dependencies(identifier_t module_name,
 
     util_t::update_status("tracing definitions ... ");
 
-    dependence_t dependence = { DEP_ORDINARY, identifier, module_ds };
+    symbol_t id = symtab_t::intern(identifier);
+
+    root_module = module_ds;
+    root_id = id;
+    uint8_t mode = summaries != nullptr ? query_cache_t::MODE_SUMMARY :
+        query_cache_t::MODE_FULL;
+
+    cached_result = false;
+
+    if (cache != nullptr) {
+        cache_generation = cache->generation();
+    }
+
+    // Results depend on the cuts and the bound, which the cache ignores.
+    bool cacheable = cuts == nullptr && (cycle_bound == util_t::k_no_index ||
+            summaries != nullptr);
+
+    if (cache != nullptr && cacheable) {
+        query_cache_t::result_t result;
+
+        if (cache->find_result(module_ds, id, mode, result)) {
+            timing_deps.swap(result.timing_deps);
+            non_timing_deps.swap(result.non_timing_deps);
+
+            cached_result = true;
+            return timing_deps.size() > 0 || non_timing_deps.size() > 0;
+        }
+    }
+
+    uint32_t node = flow_graph_t::k_no_node;
+    bool separate = separate_channels && cycle_bound == util_t::k_no_index;
+
+    if (graph != nullptr && separate == false) {
+        node = graph->node(module_ds, id);
+    }
+
+    if (summaries != nullptr) {
+        compute_summarized_dependencies(module_ds, id);
+    } else if (node != flow_graph_t::k_no_node) {
+        compute_graph_dependencies(node);
+    } else {
+        compute_full_dependencies(module_ds, id, module_map);
+    }
+
+    // Truncated results are partial; they are never cached.
+    if (cache != nullptr && truncated() == false && cacheable) {
+        query_cache_t::result_t result = { timing_deps, non_timing_deps };
+        cache->add_result(module_ds, id, mode, result, cache_generation);
+    }
+
+    return timing_deps.size() > 0 || non_timing_deps.size() > 0;
+}
+
+void dep_analysis_t::compute_full_dependencies(module_t* module_ds,
+        symbol_t id, module_map_t& module_map) {
+    bool separate = separate_channels && cycle_bound == util_t::k_no_index;
+    channels = separate ? (state_t) DEP_ORDINARY : (state_t) DEP_BOTH;
+
+    // The queried identifier itself is not reported as a leak.
+    dependence_t dependence = { DEP_ORDINARY, id, module_ds };
+    node_t node = { DEP_ORDINARY, DEP_ORDINARY };
+
+    nodes[module_ds][id] = node;
     workset.insert(dependence);
-    seen_set.insert(dependence);
+    run_worklist(module_map);
+
+    // Every further pass crosses one more register.
+    while (next_cycle.size() > 0 && truncated() == false) {
+        dep_list_t reached;
+        reached.swap(next_cycle);
+        cycle += 1;
+
+        for (dependence_t& later : reached) {
+            add_new_id(later.id, later.type, later.module_ds);
+        }
+
+        run_worklist(module_map);
+    }
+
+    if (separate) {
+        dep_list_t timing_roots;
+        timing_roots.swap(deferred);
+
+        channels = DEP_BOTH;
+
+        for (dependence_t& dependence : timing_roots) {
+            add_new_id(dependence.id, DEP_TIMING, dependence.module_ds);
+        }
+
+        run_worklist(module_map);
+    }
+
+    cached_expansion.reset();
+}
+
+/*! \brief propagate the pending bits of the worklist to a fixpoint.
+ *
+ * Types only rise, so every pair is expanded at most once per type.
+ */
+void dep_analysis_t::run_worklist(module_map_t& module_map) {
+    while (workset.size() > 0) {
+        if (budget != nullptr && budget->charge(reached_count) == false) {
+            break;
+        }
 
-    do {
         dep_set_t::iterator it = workset.begin();
 
         dependence_t dependence = *it;
-        module_t* module_ds = dependence.module_ds;
-
         workset.erase(it);
-        instr_set_t& instr_set = module_ds->def_instrs(dependence.id);
 
-        for (instr_t* instr : instr_set) {
-            module_t* new_module_ds = instr->parent()->parent();
+        node_t& node = nodes[dependence.module_ds][dependence.id];
+        dependence.type = node.pending;
+        node.pending = 0;
+
+        expansion_t& expansion = find_expansion(dependence);
+        instr_count += expansion.instrs;
+
+        apply_expansion(expansion, dependence, module_map);
+    }
+}
+
+/*! \brief raise the lattice value of a node, like add_new_id().
+ */
+void dep_analysis_t::add_graph_node(uint32_t node_idx, state_t type) {
+    node_t& node = graph_nodes[node_idx];
+    state_t new_type = type & ~node.value;
+
+    if (new_type == 0) {
+        return;
+    }
 
-            // We check for redundancy inside the following method.
-            new_module_ds->build_dominator_sets();
+    symbol_t qualified = graph->qualified_port(node_idx);
 
-            gather_dependencies(instr, dependence, module_map);
+    if (qualified != util_t::k_no_index) {
+        if (new_type & DEP_TIMING) {
+            timing_deps.insert(qualified);
         }
-    } while (workset.size() > 0);
 
-    return timing_deps.size() > 0 || non_timing_deps.size() > 0;
+        if (new_type & DEP_ORDINARY) {
+            non_timing_deps.insert(qualified);
+        }
+    }
+
+    if (cut_node(node_idx)) {
+        reached_count += node.value == 0 ? 1 : 0;
+        node.value |= new_type;
+        return;
+    }
+
+    if (node.pending == 0) {
+        graph_workset.push_back(node_idx);
+    }
+
+    bool first_seen = node.value == 0;
+
+    node.value |= new_type;
+    node.pending |= new_type;
+
+    if (first_seen == false) {
+        return;
+    }
+
+    reached_count += 1;
+
+    // Taint the ports connected to the node in expanded instances.
+    for (uint32_t conn_idx : graph->connections(node_idx)) {
+        flow_graph_t::connection_t& connection = graph->connection(conn_idx);
+        state_t instance_type = graph_instances[connection.instance];
+
+        if (instance_type != 0) {
+            add_graph_node(connection.port, instance_type);
+        }
+    }
+}
+
+/*! \brief taint the ports of an instance whose connections have been reached,
+ * like gather_inter_module_dependencies().
+ */
+void dep_analysis_t::cross_graph_instance(uint32_t instance_idx,
+        state_t type) {
+    state_t new_type = type & ~graph_instances[instance_idx];
+
+    if (new_type == 0) {
+        return;
+    }
+
+    graph_instances[instance_idx] |= new_type;
+
+    flow_graph_t::instance_t& instance = graph->instance(instance_idx);
+    uint32_t last = instance.first_connection + instance.connection_count;
+
+    for (uint32_t conn_idx = instance.first_connection; conn_idx < last;
+            conn_idx++) {
+        for (uint32_t conn_id : graph->connected_ids(conn_idx)) {
+            if (graph_nodes[conn_id].value != 0 &&
+                    cut_node(conn_id) == false) {
+                add_graph_node(graph->connection(conn_idx).port, new_type);
+                break;
+            }
+        }
+    }
+}
+
+/*! \brief propagate the pending bits of the graph worklist to a fixpoint,
+ * like run_worklist().
+ */
+void dep_analysis_t::run_graph_worklist() {
+    bool bounded = cycle_bound != util_t::k_no_index;
+
+    while (graph_workset.size() > 0) {
+        if (budget != nullptr && budget->charge(reached_count) == false) {
+            break;
+        }
+
+        uint32_t node_idx = graph_workset.back();
+        graph_workset.pop_back();
+
+        state_t type = graph_nodes[node_idx].pending;
+        graph_nodes[node_idx].pending = 0;
+
+        instr_count += graph->instrs(node_idx);
+
+        for (uint32_t edge : graph->successors(node_idx)) {
+            bool timing = (edge & 3) == flow_graph_t::EDGE_TIMING;
+            state_t edge_type = timing ? (state_t) DEP_TIMING : type;
+
+            // A bounded query crosses registers in its next pass, if any.
+            if (bounded && (edge & flow_graph_t::k_edge_register)) {
+                if (cycle < cycle_bound) {
+                    graph_next_cycle.push_back(std::make_pair(edge >> 3,
+                                edge_type));
+                }
+
+                continue;
+            }
+
+            add_graph_node(edge >> 3, edge_type);
+        }
+
+        for (uint32_t instance_idx : graph->instances(node_idx)) {
+            cross_graph_instance(instance_idx, type);
+        }
+    }
+}
+
+/*! \brief trace a query over the compiled flow graph.
+ *
+ * The lattice values live in arrays indexed by node, and the worklist is a
+ * plain stack: the result is a least fixpoint, so the order of the
+ * traversal does not matter.
+ */
+void dep_analysis_t::compute_graph_dependencies(uint32_t root) {
+    node_t none = { 0, 0 };
+
+    graph_nodes.assign(graph->size(), none);
+    graph_instances.assign(graph->instance_count(), 0);
+    graph_workset.clear();
+
+    // The queried identifier itself is not reported as a leak.
+    graph_nodes[root].value = graph_nodes[root].pending = DEP_ORDINARY;
+    graph_workset.push_back(root);
+    run_graph_worklist();
+
+    // Every further pass crosses one more register.
+    while (graph_next_cycle.size() > 0 && truncated() == false) {
+        std::vector<std::pair<uint32_t, state_t> > reached;
+        reached.swap(graph_next_cycle);
+        cycle += 1;
+
+        for (auto& later : reached) {
+            add_graph_node(later.first, later.second);
+        }
+
+        run_graph_worklist();
+    }
+}
+
+void dep_analysis_t::compute_summarized_dependencies(module_t* module_ds,
+        symbol_t id) {
+    summary_table_t::summary_t result;
+    summaries->trace(module_ds, id, result, instr_count, cuts);
+
+    for (summary_table_t::typed_id_t& entry : result.ports) {
+        if (entry.second & DEP_TIMING) {
+            timing_deps.insert(entry.first);
+        }
+
+        if (entry.second & DEP_ORDINARY) {
+            non_timing_deps.insert(entry.first);
+        }
+    }
+}
+
+/*! \brief count of instructions visited by the last query.
+ */
+uint64_t dep_analysis_t::visited_instrs() {
+    return instr_count;
 }
 
 /*! \brief list of module ports that are leaked through timing channels.
+ *
+ * Each symbol refers to the qualified ("module.port") name of the port.
  */
 id_set_t& dep_analysis_t::leaking_timing_deps() {
     return timing_deps;
 }
 
 /*! \brief list of module ports that are leaked through non-timing channels.
+ *
+ * Each symbol refers to the qualified ("module.port") name of the port.
  */
 id_set_t& dep_analysis_t::leaking_non_timing_deps() {
     return non_timing_deps;
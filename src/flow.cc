@@ -0,0 +1,308 @@
+#include <algorithm>
+
+#include "dependence.h"
+#include "flow.h"
+
+uint32_t flow_graph_t::intern(module_t* module_ds, symbol_t id) {
+    auto result = node_index.emplace(item_t(module_ds, id), nodes.size());
+
+    if (result.second) {
+        nodes.push_back(item_t(module_ds, id));
+    }
+
+    return result.first->second;
+}
+
+/*! \brief compile the expansions of every identifier of the design.
+ *
+ * The nodes start from the ports of all modules and the identifiers defined
+ * in their blocks, and grow with every identifier that an expansion refers
+ * to.  Dominators are built first, on the threads of 'pool' if any.
+ */
+void flow_graph_t::build(module_map_t& module_map, thread_pool_t* pool) {
+    std::vector<module_t*> modules;
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        modules.push_back(it->second);
+    }
+
+    if (pool != nullptr) {
+        pool->parallel_for(modules.size(), [&modules](size_t idx) {
+            modules[idx]->build_dominator_sets();
+        });
+    }
+
+    util_t::update_status("compiling flow graph ... ");
+
+    for (module_t* module_ds : modules) {
+        for (symbol_t port : module_ds->ports()) {
+            intern(module_ds, port);
+        }
+
+        bb_t* bb = nullptr;
+
+        for (uint32_t idx = 0; (bb = module_ds->block(idx)) != nullptr;
+                idx++) {
+            for (instr_t* instr : bb->instrs()) {
+                for (symbol_t def : instr->defs()) {
+                    intern(module_ds, def);
+                }
+            }
+        }
+    }
+
+    adj_list_t edge_lists, instance_lists;
+    std::unordered_map<invoke_t*, uint32_t> invoke_index;
+    dep_analysis_t::expansion_t expansion;
+
+    for (size_t idx = 0; idx < nodes.size(); idx++) {
+        module_t* module_ds = nodes[idx].first;
+        symbol_t id = nodes[idx].second;
+
+        index_list_t node_edges, node_instance_list;
+
+        if (module_ds->is_defined(id)) {
+            dep_analysis_t::expand_dependence(module_ds, id, expansion);
+        } else {
+            expansion.steps.clear();
+            expansion.instrs = 0;
+        }
+
+        for (dep_analysis_t::step_t& step : expansion.steps) {
+            if (step.kind != dep_analysis_t::STEP_INVOKE) {
+                uint32_t kind = EDGE_EXPLICIT;
+
+                if (step.kind == dep_analysis_t::STEP_IMPLICIT) {
+                    kind = EDGE_IMPLICIT;
+                } else if (step.kind == dep_analysis_t::STEP_TIMING) {
+                    kind = EDGE_TIMING;
+                }
+
+                if (step.registered) {
+                    kind |= k_edge_register;
+                }
+
+                node_edges.push_back(intern(step.module_ds, step.id) << 3 |
+                        kind);
+                continue;
+            }
+
+            auto found = invoke_index.find(step.invoke);
+
+            if (found == invoke_index.end()) {
+                module_map_t::iterator callee_it =
+                    module_map.find(step.invoke->module_name());
+
+                if (callee_it == module_map.end()) {
+                    continue;
+                }
+
+                instance_t instance = { step.invoke, callee_it->second,
+                    (uint32_t) connection_list.size(), 0 };
+
+                for (conn_t& conn : step.invoke->connections()) {
+                    connection_t connection = { (uint32_t) instance_list.size(),
+                        intern(callee_it->second, conn.remote_endpoint),
+                        (uint32_t) connection_ids.size(),
+                        (uint32_t) conn.id_set.size() };
+
+                    for (symbol_t conn_id : conn.id_set) {
+                        connection_ids.push_back(intern(step.module_ds,
+                                    conn_id));
+                    }
+
+                    connection_list.push_back(connection);
+                    instance.connection_count += 1;
+                }
+
+                found = invoke_index.emplace(step.invoke,
+                        instance_list.size()).first;
+                instance_list.push_back(instance);
+            }
+
+            node_instance_list.push_back(found->second);
+        }
+
+        std::sort(node_edges.begin(), node_edges.end());
+        node_edges.erase(std::unique(node_edges.begin(), node_edges.end()),
+                node_edges.end());
+
+        std::sort(node_instance_list.begin(), node_instance_list.end());
+        node_instance_list.erase(std::unique(node_instance_list.begin(),
+                    node_instance_list.end()), node_instance_list.end());
+
+        edge_lists.resize(nodes.size());
+        instance_lists.resize(nodes.size());
+
+        edge_lists[idx].swap(node_edges);
+        instance_lists[idx].swap(node_instance_list);
+        instr_counts.push_back(expansion.instrs);
+    }
+
+    edge_lists.resize(nodes.size());
+    instance_lists.resize(nodes.size());
+
+    edges.build(edge_lists);
+    node_instances.build(instance_lists);
+
+    adj_list_t connection_lists(nodes.size());
+
+    for (uint32_t idx = 0; idx < connection_list.size(); idx++) {
+        for (uint32_t conn_id : connected_ids(idx)) {
+            connection_lists[conn_id].push_back(idx);
+        }
+    }
+
+    node_connections.build(connection_lists);
+
+    adj_list_t reverse_lists(nodes.size());
+    adj_list_t defined_lists(instance_list.size());
+    adj_list_t port_lists(nodes.size());
+
+    for (uint32_t idx = 0; idx < nodes.size(); idx++) {
+        for (uint32_t edge : edges[idx]) {
+            reverse_lists[edge >> 3].push_back(idx << 3 | (edge & 7));
+        }
+
+        for (uint32_t instance_idx : node_instances[idx]) {
+            defined_lists[instance_idx].push_back(idx);
+        }
+    }
+
+    for (connection_t& connection : connection_list) {
+        index_list_t& port_list = port_lists[connection.port];
+
+        if (port_list.size() == 0 || port_list.back() != connection.instance) {
+            port_list.push_back(connection.instance);
+        }
+    }
+
+    reverse_edges.build(reverse_lists);
+    instance_nodes.build(defined_lists);
+    port_instances.build(port_lists);
+
+    qualified_ports.assign(nodes.size(), util_t::k_no_index);
+
+    for (uint32_t idx = 0; idx < nodes.size(); idx++) {
+        if (nodes[idx].first->port_exists(nodes[idx].second)) {
+            qualified_ports[idx] =
+                nodes[idx].first->qualified_port(nodes[idx].second);
+        }
+    }
+
+    util_t::clear_status();
+}
+
+/*! \brief count of nodes.
+ */
+uint32_t flow_graph_t::size() {
+    return nodes.size();
+}
+
+/*! \brief node of an identifier of a module, or k_no_node.
+ */
+uint32_t flow_graph_t::node(module_t* module_ds, symbol_t id) {
+    item_map_t::iterator it = node_index.find(item_t(module_ds, id));
+
+    if (it == node_index.end()) {
+        return k_no_node;
+    }
+
+    return it->second;
+}
+
+module_t* flow_graph_t::module_of(uint32_t node) {
+    return nodes[node].first;
+}
+
+symbol_t flow_graph_t::id_of(uint32_t node) {
+    return nodes[node].second;
+}
+
+/*! \brief qualified ("module.port") name of a node, or util_t::k_no_index
+ * if the node is not a port.
+ */
+symbol_t flow_graph_t::qualified_port(uint32_t node) {
+    return qualified_ports[node];
+}
+
+/*! \brief count of instructions that define a node.
+ */
+uint32_t flow_graph_t::instrs(uint32_t node) {
+    return instr_counts[node];
+}
+
+/*! \brief edges of a node, as (target << 3 | kind).
+ */
+csr_t::range_t flow_graph_t::successors(uint32_t node) {
+    return edges[node];
+}
+
+/*! \brief module instances that define a node.
+ */
+csr_t::range_t flow_graph_t::instances(uint32_t node) {
+    return node_instances[node];
+}
+
+/*! \brief connections that a node is connected to.
+ */
+csr_t::range_t flow_graph_t::connections(uint32_t node) {
+    return node_connections[node];
+}
+
+/*! \brief edges into a node, as (source << 3 | kind).
+ */
+csr_t::range_t flow_graph_t::predecessors(uint32_t node) {
+    return reverse_edges[node];
+}
+
+/*! \brief module instances whose connections include a port node of the
+ * invoked module.
+ */
+csr_t::range_t flow_graph_t::instantiations(uint32_t node) {
+    return port_instances[node];
+}
+
+uint32_t flow_graph_t::instance_count() {
+    return instance_list.size();
+}
+
+flow_graph_t::instance_t& flow_graph_t::instance(uint32_t idx) {
+    return instance_list[idx];
+}
+
+flow_graph_t::connection_t& flow_graph_t::connection(uint32_t idx) {
+    return connection_list[idx];
+}
+
+/*! \brief nodes connected to a port of an instance.
+ */
+csr_t::range_t flow_graph_t::connected_ids(uint32_t idx) {
+    const uint32_t* first = connection_ids.data() +
+        connection_list[idx].first_id;
+
+    return csr_t::range_t(first, first + connection_list[idx].id_count);
+}
+
+/*! \brief nodes defined by a module instance.
+ */
+csr_t::range_t flow_graph_t::defined_nodes(uint32_t idx) {
+    return instance_nodes[idx];
+}
+
+/*! \brief approximate memory used by the graph.
+ */
+size_t flow_graph_t::bytes() {
+    size_t edge_count = 0;
+
+    for (uint32_t idx = 0; idx < nodes.size(); idx++) {
+        edge_count += 2 * (edges[idx].size() + node_instances[idx].size()) +
+            node_connections[idx].size() + port_instances[idx].size();
+    }
+
+    return nodes.size() * (sizeof(item_t) + 4 * sizeof(uint32_t) + 32) +
+        edge_count * sizeof(uint32_t) +
+        instance_list.size() * sizeof(instance_t) +
+        connection_list.size() * sizeof(connection_t) +
+        connection_ids.size() * sizeof(uint32_t);
+}
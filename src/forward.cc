@@ -0,0 +1,417 @@
+#include <cassert>
+
+#include "forward.h"
+
+forward_analysis_t::forward_analysis_t() {
+    instr_count = 0;
+    graph = nullptr;
+    modules = nullptr;
+
+    budget = nullptr;
+    reached_count = 0;
+
+    cuts = nullptr;
+    root_module = nullptr;
+    root_id = 0;
+
+    cycle_bound = util_t::k_no_index;
+    cycle = 0;
+}
+
+/*! \brief traverse the reverse edges of the compiled flow graph instead of
+ * the def-use chains of the modules.
+ */
+void forward_analysis_t::use_graph(flow_graph_t* __graph) {
+    graph = __graph;
+}
+
+/*! \brief stop queries once 'budget' is exhausted (see
+ * dep_analysis_t::use_budget()).
+ */
+void forward_analysis_t::use_budget(query_budget_t* __budget) {
+    budget = __budget;
+}
+
+/*! \brief stop queries at the nets of 'cuts' (see cut_set_t).
+ */
+void forward_analysis_t::use_cuts(cut_set_t* __cuts) {
+    cuts = __cuts;
+}
+
+/*! \brief stop queries at paths that cross more than 'cycles' registers
+ * (see dep_analysis_t::use_cycle_bound()).
+ */
+void forward_analysis_t::use_cycle_bound(uint32_t cycles) {
+    cycle_bound = cycles;
+}
+
+/*! \brief check whether the last query ran out of budget.
+ */
+bool forward_analysis_t::truncated() {
+    return budget != nullptr &&
+        budget->exhausted_limit() != query_budget_t::LIMIT_NONE;
+}
+
+bool forward_analysis_t::cut(module_t* module_ds, symbol_t id) {
+    return cuts != nullptr && (module_ds != root_module || id != root_id) &&
+        cuts->contains(module_ds, id);
+}
+
+/*! \brief raise the lattice value of a pair, and report it if it is a port.
+ *
+ * Cut pairs are reported, but never queued.
+ */
+void forward_analysis_t::add_flow(module_t* module_ds, symbol_t id,
+        state_t type) {
+    node_t& node = nodes[item_t(module_ds, id)];
+    state_t new_type = type & ~node.value;
+
+    if (new_type == 0) {
+        return;
+    }
+
+    if (module_ds->port_exists(id)) {
+        symbol_t qualified = module_ds->qualified_port(id);
+
+        if (new_type & DEP_TIMING) {
+            timing_flows.insert(qualified);
+        }
+
+        if (new_type & DEP_ORDINARY) {
+            non_timing_flows.insert(qualified);
+        }
+    }
+
+    if (cut(module_ds, id)) {
+        reached_count += node.value == 0 ? 1 : 0;
+        node.value |= new_type;
+        return;
+    }
+
+    if (node.pending == 0) {
+        workset.push_back(item_t(module_ds, id));
+    }
+
+    if (node.value == 0) {
+        reached_count += 1;
+    }
+
+    node.value |= new_type;
+    node.pending |= new_type;
+}
+
+/*! \brief add the identifiers that an instruction defines, including, for a
+ * module instance, the ports of the invoked module that it drives.
+ *
+ * A bounded query adds the registers that the instruction defines in its
+ * next pass, if any, unless they are reached through the trigger of their
+ * block ('triggered'), which acts in the same cycle.
+ */
+void forward_analysis_t::add_defined_ids(instr_t* instr, state_t type,
+        bool triggered) {
+    module_t* module_ds = instr->parent()->parent();
+
+    if (instr->kind() != INSTR_INVOKE) {
+        bool later = cycle_bound != util_t::k_no_index &&
+            triggered == false && module_ds->clocked_block(instr->parent());
+
+        for (symbol_t def : instr->defs()) {
+            if (later == false) {
+                add_flow(module_ds, def, type);
+            } else if (cycle < cycle_bound) {
+                next_cycle.push_back(typed_item_t(item_t(module_ds, def),
+                            type));
+            }
+        }
+
+        return;
+    }
+
+    invoke_t* invoke = static_cast<invoke_t*>(instr);
+    module_map_t::iterator it = modules->find(invoke->module_name());
+
+    if (it == modules->end()) {
+        return;
+    }
+
+    for (conn_t& connection : invoke->connections()) {
+        if (connection.state & STATE_USE) {
+            for (symbol_t id : connection.id_set) {
+                add_flow(module_ds, id, type);
+            }
+        }
+
+        if (connection.state & STATE_DEF) {
+            add_flow(it->second, connection.remote_endpoint, type);
+        }
+    }
+}
+
+void forward_analysis_t::add_block_defs(module_t* module_ds, uint32_t idx,
+        state_t type, bool triggered) {
+    bb_t* bb = module_ds->block(idx);
+
+    for (instr_t* instr : bb->instrs()) {
+        add_defined_ids(instr, type, triggered);
+    }
+
+    instr_count += bb->instrs().size();
+}
+
+/*! \brief propagate a pair to the pairs that depend on it.
+ *
+ * These are the definitions of the instructions that use it, of the blocks
+ * that it guards and of the 'always' blocks that it triggers.  The def-use
+ * chains of a port of an invoked module also lead to its instances.
+ */
+void forward_analysis_t::expand_flow(module_t* module_ds, symbol_t id,
+        state_t type) {
+    // We check for redundancy inside the following method.
+    module_ds->build_dominator_sets();
+
+    if (module_ds->is_used(id)) {
+        for (instr_t* instr : module_ds->use_instrs(id)) {
+            instr_count += 1;
+
+            // The connections of a local instance do not define anything.
+            if (instr->kind() != INSTR_INVOKE ||
+                    instr->parent()->parent() != module_ds) {
+                add_defined_ids(instr, type, false);
+            }
+        }
+    }
+
+    if (module_ds->is_defined(id)) {
+        for (instr_t* instr : module_ds->def_instrs(id)) {
+            if (instr->kind() == INSTR_INVOKE &&
+                    instr->parent()->parent() != module_ds) {
+                instr_count += 1;
+                add_defined_ids(instr, type, false);
+            }
+        }
+    }
+
+    for (uint32_t idx : module_ds->implicit_flow_blocks(id)) {
+        add_block_defs(module_ds, idx, type, false);
+    }
+
+    for (uint32_t idx : module_ds->timing_trigger_blocks(id)) {
+        add_block_defs(module_ds, idx, DEP_TIMING, true);
+    }
+}
+
+void forward_analysis_t::run_worklist() {
+    while (workset.size() > 0) {
+        if (budget != nullptr && budget->charge(reached_count) == false) {
+            break;
+        }
+
+        item_t item = workset.back();
+        workset.pop_back();
+
+        node_t& node = nodes[item];
+        state_t type = node.pending;
+        node.pending = 0;
+
+        expand_flow(item.first, item.second, type);
+    }
+}
+
+void forward_analysis_t::compute_full_flows(module_t* module_ds,
+        symbol_t id) {
+    // The queried identifier itself is not reported as a flow.
+    node_t root = { DEP_ORDINARY, DEP_ORDINARY };
+
+    nodes[item_t(module_ds, id)] = root;
+    workset.push_back(item_t(module_ds, id));
+    run_worklist();
+
+    // Every further pass crosses one more register.
+    while (next_cycle.size() > 0 && truncated() == false) {
+        std::vector<typed_item_t> reached;
+        reached.swap(next_cycle);
+        cycle += 1;
+
+        for (typed_item_t& later : reached) {
+            add_flow(later.first.first, later.first.second, later.second);
+        }
+
+        run_worklist();
+    }
+}
+
+/*! \brief raise the lattice value of a node, like add_flow().
+ */
+void forward_analysis_t::add_graph_node(uint32_t node_idx, state_t type) {
+    node_t& node = graph_nodes[node_idx];
+    state_t new_type = type & ~node.value;
+
+    if (new_type == 0) {
+        return;
+    }
+
+    symbol_t qualified = graph->qualified_port(node_idx);
+
+    if (qualified != util_t::k_no_index) {
+        if (new_type & DEP_TIMING) {
+            timing_flows.insert(qualified);
+        }
+
+        if (new_type & DEP_ORDINARY) {
+            non_timing_flows.insert(qualified);
+        }
+    }
+
+    if (cuts != nullptr && cut(graph->module_of(node_idx),
+                graph->id_of(node_idx))) {
+        reached_count += node.value == 0 ? 1 : 0;
+        node.value |= new_type;
+        return;
+    }
+
+    if (node.pending == 0) {
+        graph_workset.push_back(node_idx);
+    }
+
+    if (node.value == 0) {
+        reached_count += 1;
+    }
+
+    node.value |= new_type;
+    node.pending |= new_type;
+}
+
+void forward_analysis_t::run_graph_worklist() {
+    bool bounded = cycle_bound != util_t::k_no_index;
+
+    while (graph_workset.size() > 0) {
+        if (budget != nullptr && budget->charge(reached_count) == false) {
+            break;
+        }
+
+        uint32_t node_idx = graph_workset.back();
+        graph_workset.pop_back();
+
+        state_t type = graph_nodes[node_idx].pending;
+        graph_nodes[node_idx].pending = 0;
+
+        csr_t::range_t preds = graph->predecessors(node_idx);
+        instr_count += preds.size();
+
+        for (uint32_t edge : preds) {
+            bool timing = (edge & 3) == flow_graph_t::EDGE_TIMING;
+            state_t edge_type = timing ? (state_t) DEP_TIMING : type;
+
+            if (bounded && (edge & flow_graph_t::k_edge_register)) {
+                if (cycle < cycle_bound) {
+                    graph_next_cycle.push_back(std::make_pair(edge >> 3,
+                                edge_type));
+                }
+
+                continue;
+            }
+
+            add_graph_node(edge >> 3, edge_type);
+        }
+
+        for (uint32_t instance_idx : graph->instantiations(node_idx)) {
+            for (uint32_t defined : graph->defined_nodes(instance_idx)) {
+                add_graph_node(defined, type);
+            }
+        }
+    }
+}
+
+/*! \brief trace a query over the reverse edges of the compiled flow graph.
+ */
+void forward_analysis_t::compute_graph_flows(uint32_t root) {
+    node_t none = { 0, 0 };
+
+    graph_nodes.assign(graph->size(), none);
+    graph_workset.clear();
+
+    graph_nodes[root].value = graph_nodes[root].pending = DEP_ORDINARY;
+    graph_workset.push_back(root);
+    run_graph_worklist();
+
+    // Every further pass crosses one more register.
+    while (graph_next_cycle.size() > 0 && truncated() == false) {
+        std::vector<std::pair<uint32_t, state_t> > reached;
+        reached.swap(graph_next_cycle);
+        cycle += 1;
+
+        for (auto& later : reached) {
+            add_graph_node(later.first, later.second);
+        }
+
+        run_graph_worklist();
+    }
+}
+
+/*! \brief count of instructions (or graph edges) visited by the last query.
+ */
+uint64_t forward_analysis_t::visited_instrs() {
+    return instr_count;
+}
+
+/*! \brief ports into which the queried identifier flows through timing.
+ */
+id_set_t& forward_analysis_t::timing_sinks() {
+    return timing_flows;
+}
+
+/*! \brief ports into which the queried identifier flows otherwise.
+ */
+id_set_t& forward_analysis_t::non_timing_sinks() {
+    return non_timing_flows;
+}
+
+/*! \brief find every port that an identifier of a module flows into.
+ *
+ * Returns true if it flows into any port.
+ */
+bool forward_analysis_t::compute_flows(identifier_t module_name,
+        identifier_t identifier, module_map_t& module_map) {
+    nodes.clear();
+    workset.clear();
+
+    timing_flows.clear();
+    non_timing_flows.clear();
+
+    instr_count = 0;
+    reached_count = 0;
+    modules = &module_map;
+
+    cycle = 0;
+    next_cycle.clear();
+    graph_next_cycle.clear();
+
+    if (budget != nullptr) {
+        budget->start();
+    }
+
+    module_map_t::iterator it = module_map.find(module_name);
+    assert(it != module_map.end() && "failed to find requested module!");
+
+    module_t* module_ds = it->second;
+
+    util_t::update_status("tracing uses ... ");
+
+    symbol_t id = symtab_t::intern(identifier);
+    uint32_t node = flow_graph_t::k_no_node;
+
+    root_module = module_ds;
+    root_id = id;
+
+    if (graph != nullptr) {
+        node = graph->node(module_ds, id);
+    }
+
+    if (node != flow_graph_t::k_no_node) {
+        compute_graph_flows(node);
+    } else {
+        compute_full_flows(module_ds, id);
+    }
+
+    return timing_flows.size() > 0 || non_timing_flows.size() > 0;
+}
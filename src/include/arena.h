@@ -0,0 +1,68 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+/*!
+ * Bump allocator that owns the IR (basic blocks and instructions) of a module.
+ *
+ * Objects are carved out of large chunks and are never freed individually.
+ * When the arena is destroyed, the destructors of the objects it holds run in
+ * reverse order of construction and then the chunks are released.
+ */
+class arena_t {
+  private:
+    typedef void (*destructor_t)(void*);
+
+    typedef struct {
+        void* object;
+        destructor_t destructor;
+    } finalizer_t;
+
+    static const size_t k_chunk_size = 256 * 1024;
+
+    char* cursor;
+    char* limit;
+    size_t reserved;
+    std::vector<char*> chunks;
+    std::vector<finalizer_t> finalizers;
+
+    void* allocate(size_t, size_t);
+
+    template <typename T>
+    static void destroy(void* object) {
+        static_cast<T*>(object)->~T();
+    }
+
+  public:
+    arena_t();
+    ~arena_t();
+
+    // disable copy constructor.
+    arena_t(const arena_t&) = delete;
+
+    /*! \brief construct a new object inside the arena.
+     */
+    template <typename T, typename... args_t>
+    T* make(args_t&&... args) {
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* object = new (memory) T(std::forward<args_t>(args)...);
+
+        if (std::is_trivially_destructible<T>::value == false) {
+            finalizer_t finalizer = { object, &destroy<T> };
+            finalizers.push_back(finalizer);
+        }
+
+        return object;
+    }
+
+    size_t bytes_reserved();
+    size_t chunk_count();
+};
+
+#endif  // ARENA_H_
@@ -0,0 +1,59 @@
+#ifndef BUDGET_H_
+#define BUDGET_H_
+
+#include <chrono>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * Limits on the resources of a single query: wall time, worklist pops, and
+ * the memory of the pairs that it reached.  A limit of zero is unlimited.
+ *
+ * Engines charge the budget once per pop and stop as soon as it is
+ * exhausted, keeping what they found so far.  The memory is estimated from
+ * the pairs reached by the query itself, since the resident size of the
+ * process is shared by concurrent queries.
+ */
+class query_budget_t {
+  public:
+    enum {
+        LIMIT_NONE = 0,
+        LIMIT_TIME,
+        LIMIT_POPS,
+        LIMIT_MEMORY,
+    };
+
+    // Approximate memory of a reached pair, with its worklist entry.
+    static const size_t k_pair_bytes = 64;
+
+  private:
+    typedef std::chrono::steady_clock::time_point time_point_t;
+
+    // The time is only read every 'k_time_period' pops.
+    static const uint64_t k_time_period = 64;
+
+    uint64_t max_milliseconds;
+    uint64_t max_pops;
+    uint64_t max_bytes;
+
+    time_point_t start_time;
+    uint64_t pops;
+    uint8_t limit;
+
+    bool out_of_time();
+
+  public:
+    query_budget_t(uint64_t, uint64_t, uint64_t);
+
+    // disable copy constructor.
+    query_budget_t(const query_budget_t&) = delete;
+
+    void start();
+    bool charge(uint64_t);
+    uint8_t exhausted_limit();
+
+    static const char* limit_name(uint8_t);
+};
+
+#endif  // BUDGET_H_
@@ -0,0 +1,105 @@
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "dependence.h"
+#include "structs.h"
+
+/*!
+ * Results of earlier queries, and the expansions of the (module, identifier)
+ * pairs that they visited, shared by all later queries.
+ *
+ * Entries are evicted least recently used first once their estimated size
+ * exceeds the memory budget.  Every entry belongs to a generation of the
+ * design; invalidate() starts a new generation (e.g. after a reload), which
+ * drops all entries and rejects those of queries that started before it.
+ */
+class query_cache_t {
+  public:
+    enum {
+        MODE_FULL    = 0,
+        MODE_SUMMARY = 1,
+    };
+
+    typedef struct {
+        id_set_t timing_deps;
+        id_set_t non_timing_deps;
+    } result_t;
+
+    typedef std::shared_ptr<dep_analysis_t::expansion_t> expansion_ptr_t;
+
+  private:
+    enum {
+        ENTRY_RESULT    = 0,
+        ENTRY_EXPANSION = 1,
+    };
+
+    typedef struct tag_key_t {
+        uint8_t kind;
+        uint8_t mode;
+        symbol_t id;
+        module_t* module_ds;
+
+        bool operator==(const struct tag_key_t& ref) const {
+            return kind == ref.kind && mode == ref.mode && id == ref.id &&
+                module_ds == ref.module_ds;
+        }
+    } key_t;
+
+    struct key_hash_t {
+        size_t operator()(const key_t& key) const {
+            return (std::hash<module_t*>()(key.module_ds) * 31 + key.id) * 4 +
+                key.kind * 2 + key.mode;
+        }
+    };
+
+    typedef std::list<key_t> lru_list_t;
+
+    typedef struct {
+        lru_list_t::iterator position;
+        size_t bytes;
+        result_t result;
+        expansion_ptr_t expansion;
+    } entry_t;
+
+    typedef std::unordered_map<key_t, entry_t, key_hash_t> entry_map_t;
+
+    std::mutex lock;
+    entry_map_t entries;
+    lru_list_t lru_list;
+
+    size_t budget;
+    size_t used_bytes;
+    uint64_t current_generation;
+
+    uint64_t hit_count, miss_count;
+    uint64_t result_count, expansion_count;
+
+    entry_t* find(const key_t&);
+    void insert(const key_t&, entry_t&, uint64_t);
+    void evict();
+    void erase(entry_map_t::iterator);
+
+  public:
+    explicit query_cache_t(size_t);
+
+    // disable copy constructor.
+    query_cache_t(const query_cache_t&) = delete;
+
+    uint64_t generation();
+    void invalidate();
+
+    bool find_result(module_t*, symbol_t, uint8_t, result_t&);
+    void add_result(module_t*, symbol_t, uint8_t, result_t&, uint64_t);
+
+    expansion_ptr_t find_expansion(module_t*, symbol_t);
+    void add_expansion(module_t*, symbol_t, expansion_ptr_t, uint64_t);
+
+    void describe(identifier_t&);
+};
+
+#endif  // CACHE_H_
@@ -0,0 +1,52 @@
+#ifndef CUT_H_
+#define CUT_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "structs.h"
+
+/*!
+ * Nets at which queries stop, e.g. the clock and reset nets that fan out to
+ * almost every 'always' block of a design.
+ *
+ * A pattern is a name, or a prefix followed by '*', matched regardless of
+ * case.  It applies to a single module, or to every module if none is
+ * given.  Engines report a cut pair when they reach it, like any other pair,
+ * but never expand it: neither its definitions (or uses, for forward
+ * queries), nor the instances that it is connected to.  The queried
+ * identifier itself is always expanded.
+ *
+ * Patterns are resolved against the symbols of a loaded design, so the set
+ * must be resolved again whenever the design changes (see resolve()).
+ */
+class cut_set_t {
+  private:
+    typedef struct {
+        identifier_t module;
+        identifier_t pattern;
+    } entry_t;
+
+    std::vector<entry_t> entries;
+
+    // Symbols cut in every module, and those cut in a single module.
+    std::vector<bool> global_ids;
+    std::unordered_map<module_t*, id_set_t> module_ids;
+    uint32_t match_count;
+
+    static bool matches(const identifier_t&, const identifier_t&);
+
+  public:
+    cut_set_t();
+
+    void add(const identifier_t&, const identifier_t&);
+    bool parse(const std::string&);
+    void resolve(module_map_t&);
+
+    bool empty();
+    size_t size();
+    uint32_t matched();
+    bool contains(module_t*, symbol_t);
+};
+
+#endif  // CUT_H_
@@ -2,18 +2,35 @@
 #ifndef DEPENDENCE_H_
 #define DEPENDENCE_H_
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "budget.h"
+#include "cut.h"
+#include "flow.h"
 #include "structs.h"
+#include "summary.h"
+
+class multi_dep_analysis_t;
+class query_cache_t;
 
 class dep_analysis_t {
   private:
-    enum {
-        DEP_TIMING   = 1,
-        DEP_ORDINARY = 2,
-    };
+    // The cache shares expansions between queries, the multi-query engine
+    // replays them for many queries at once, and the flow graph compiles
+    // them for all identifiers.
+    friend class flow_graph_t;
+    friend class multi_dep_analysis_t;
+    friend class query_cache_t;
 
+    // A pair in the worklist; the type holds the bits that the pair gained
+    // since it was last expanded (see node_t).  Pairs are ordered by module
+    // and symbol, i.e. by intern order rather than by name; the results do
+    // not depend on this order, since lattice values only ever rise.
     typedef struct tag_dependence_t {
         state_t type;
-        identifier_t id;
+        symbol_t id;
         module_t* module_ds;
 
         const bool operator<(const struct tag_dependence_t& ref) const {
@@ -21,21 +38,148 @@ class dep_analysis_t {
         }
     } dependence_t;
 
+    // Lattice value of a reached pair, and the bits not yet propagated.
+    typedef struct {
+        state_t value;
+        state_t pending;
+    } node_t;
+
+    // Types with which a module instance has been expanded.
+    typedef struct {
+        state_t type;
+        module_t* invoked_ds;
+    } invoke_state_t;
+
     typedef std::set<dependence_t> dep_set_t;
+    typedef std::unordered_map<symbol_t, node_t> node_map_t;
+    typedef std::unordered_map<module_t*, node_map_t> node_index_t;
+    typedef std::vector<dependence_t> dep_list_t;
+    typedef std::unordered_map<invoke_t*, invoke_state_t> invoke_state_map_t;
+    typedef std::unordered_map<module_t*, invoke_state_map_t> invoke_index_t;
+
+    enum {
+        STEP_SAME_TYPE = 0,
+        STEP_TIMING,
+        STEP_INVOKE,
+        STEP_IMPLICIT,
+    };
+
+    // One effect of visiting the definitions of an identifier, in the order
+    // in which the sequential engine applies them: add an identifier with
+    // the type of the visited dependence (through an explicit or an implicit
+    // flow) or as a timing dependence, or check the connections of a module
+    // instance against the seen set.  Explicit and implicit steps of
+    // definitions in triggered 'always' blocks cross a register; timing
+    // steps do not.
+    typedef struct {
+        uint8_t kind;
+        symbol_t id;
+        module_t* module_ds;
+        invoke_t* invoke;
+        bool registered;
+    } step_t;
+
+    typedef struct {
+        std::vector<step_t> steps;
+        uint64_t instrs;
+    } expansion_t;
+
+    typedef std::pair<module_t*, symbol_t> item_t;
+
+    struct item_hash_t {
+        size_t operator()(const item_t& item) const {
+            return std::hash<module_t*>()(item.first) * 31 + item.second;
+        }
+    };
 
     id_set_t timing_deps;
     id_set_t non_timing_deps;
-    dep_set_t workset, seen_set;
+    dep_set_t workset;
+
+    uint64_t instr_count;
+
+    // Limits of the query, if any, and the count of pairs it reached.
+    query_budget_t* budget;
+    uint64_t reached_count;
+
+    // Nets at which the query stops, if any, and the queried pair, which is
+    // expanded even if it is cut.
+    cut_set_t* cuts;
+    module_t* root_module;
+    symbol_t root_id;
+
+    // Registers that the query may cross, or util_t::k_no_index, the
+    // registers crossed by the pairs being expanded, and the pairs reached
+    // by crossing one more (see use_cycle_bound()).
+    uint32_t cycle_bound;
+    uint32_t cycle;
+    dep_list_t next_cycle;
+    std::vector<std::pair<uint32_t, state_t> > graph_next_cycle;
+
+    // Summaries used to cross module instances, if any.
+    summary_table_t* summaries;
+
+    // Compiled flow graph, if any, and the state of a query over it,
+    // indexed by node and by instance.
+    flow_graph_t* graph;
+    std::vector<node_t> graph_nodes;
+    std::vector<state_t> graph_instances;
+    index_list_t graph_workset;
+
+    // Results and expansions shared with other queries, if any.
+    query_cache_t* cache;
+    uint64_t cache_generation;
+    std::shared_ptr<expansion_t> cached_expansion;
+    bool cached_result;
 
+    expansion_t scratch;
+
+    // Lattice values of the reached pairs, hashed by their module.
+    node_index_t nodes;
+
+    // Expanded instances, hashed by the instantiating module.
+    invoke_index_t invokes;
+
+    // Types traced by the current pass, and the timing dependences deferred
+    // to a later pass (see use_separate_channels()).
+    state_t channels;
+    bool separate_channels;
+    dep_list_t deferred;
+
+    bool cut(module_t*, symbol_t);
+    bool cut_node(uint32_t);
+    void add_new_id(symbol_t, state_t, module_t*);
     void add_new_ids(id_set_t&, state_t, module_t*);
+    bool seen(module_t*, symbol_t);
+    void taint_connections(module_t*, symbol_t);
+    void run_worklist(module_map_t&);
 
-    void gather_timing_dependencies(instr_t*);
-    void gather_implicit_dependencies(instr_t*, state_t&);
     void gather_inter_module_dependencies(invoke_t*, state_t, module_map_t&);
-    bool gather_dependencies(instr_t* instr, dependence_t& dependence,
-            module_map_t&);
+    void apply_expansion(expansion_t&, dependence_t&, module_map_t&);
+    expansion_t& find_expansion(dependence_t&);
+    void compute_summarized_dependencies(module_t*, symbol_t);
+    void compute_full_dependencies(module_t*, symbol_t, module_map_t&);
+
+    void add_graph_node(uint32_t, state_t);
+    void cross_graph_instance(uint32_t, state_t);
+    void run_graph_worklist();
+    void compute_graph_dependencies(uint32_t);
+
+    static void expand_dependence(module_t*, symbol_t, expansion_t&);
 
   public:
+    dep_analysis_t();
+
+    void use_summaries(summary_table_t*);
+    void use_cache(query_cache_t*);
+    void use_graph(flow_graph_t*);
+    void use_budget(query_budget_t*);
+    void use_cuts(cut_set_t*);
+    void use_cycle_bound(uint32_t);
+    void use_separate_channels(bool);
+    bool from_cache();
+    bool truncated();
+    uint64_t visited_instrs();
     id_set_t& leaking_timing_deps();
     id_set_t& leaking_non_timing_deps();
     bool compute_dependencies(identifier_t, identifier_t, module_map_t&);
@@ -0,0 +1,115 @@
+#ifndef FLOW_H_
+#define FLOW_H_
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pool.h"
+#include "structs.h"
+
+/*!
+ * Explicit value-flow graph of a design, compiled once after loading it.
+ *
+ * Nodes are the (module, identifier) pairs of the design, numbered densely.
+ * The edges of a node are the expansions of dep_analysis_t, compiled into
+ * contiguous arrays: explicit flows (uses of the defining instructions),
+ * implicit flows (uses of the guarding comparisons) and timing flows
+ * (triggers of 'always' blocks), as (target << 3 | kind).  Explicit and
+ * implicit edges are flagged with k_edge_register if the defining
+ * instruction is in a triggered 'always' block, i.e. if the edge crosses a
+ * register; timing edges act in the same cycle.  Module instances that
+ * define a node are kept as instances, whose connections map the connected
+ * identifiers of the instantiating module to the ports of the invoked
+ * module.  The edges and instances are also kept reversed, for forward
+ * queries.
+ */
+class flow_graph_t {
+  public:
+    enum {
+        EDGE_EXPLICIT = 0,
+        EDGE_IMPLICIT,
+        EDGE_TIMING,
+    };
+
+    static const uint32_t k_no_node = UINT32_MAX;
+    static const uint32_t k_edge_register = 4;
+
+    typedef struct {
+        invoke_t* invoke;
+        module_t* invoked_ds;
+        uint32_t first_connection;
+        uint32_t connection_count;
+    } instance_t;
+
+    // Port of the invoked module, and the identifiers connected to it.
+    typedef struct {
+        uint32_t instance;
+        uint32_t port;
+        uint32_t first_id;
+        uint32_t id_count;
+    } connection_t;
+
+  private:
+    typedef std::pair<module_t*, symbol_t> item_t;
+
+    struct item_hash_t {
+        size_t operator()(const item_t& item) const {
+            return std::hash<module_t*>()(item.first) * 31 + item.second;
+        }
+    };
+
+    typedef std::unordered_map<item_t, uint32_t, item_hash_t> item_map_t;
+
+    std::vector<item_t> nodes;
+    item_map_t node_index;
+
+    // Qualified port name of every node, or util_t::k_no_index.
+    index_list_t qualified_ports;
+    index_list_t instr_counts;
+
+    csr_t edges;
+    csr_t node_instances;
+    csr_t node_connections;
+
+    csr_t reverse_edges;
+    csr_t instance_nodes;
+    csr_t port_instances;
+
+    std::vector<instance_t> instance_list;
+    std::vector<connection_t> connection_list;
+    index_list_t connection_ids;
+
+    uint32_t intern(module_t*, symbol_t);
+
+  public:
+    flow_graph_t() = default;
+
+    // disable copy constructor.
+    flow_graph_t(const flow_graph_t&) = delete;
+
+    void build(module_map_t&, thread_pool_t*);
+
+    uint32_t size();
+    uint32_t node(module_t*, symbol_t);
+    module_t* module_of(uint32_t);
+    symbol_t id_of(uint32_t);
+    symbol_t qualified_port(uint32_t);
+    uint32_t instrs(uint32_t);
+
+    csr_t::range_t successors(uint32_t);
+    csr_t::range_t instances(uint32_t);
+    csr_t::range_t connections(uint32_t);
+    csr_t::range_t predecessors(uint32_t);
+    csr_t::range_t instantiations(uint32_t);
+
+    uint32_t instance_count();
+    instance_t& instance(uint32_t);
+    connection_t& connection(uint32_t);
+    csr_t::range_t connected_ids(uint32_t);
+    csr_t::range_t defined_nodes(uint32_t);
+
+    size_t bytes();
+};
+
+#endif  // FLOW_H_
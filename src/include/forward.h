@@ -0,0 +1,105 @@
+#ifndef FORWARD_H_
+#define FORWARD_H_
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "budget.h"
+#include "cut.h"
+#include "flow.h"
+#include "structs.h"
+
+/*!
+ * Engine that traces where an identifier flows, i.e. the ports that it
+ * leaks into.
+ *
+ * The traversal follows the edges of dep_analysis_t in reverse: from an
+ * identifier to the definitions of the instructions that use it (use_map),
+ * of the blocks that it guards, and of the 'always' blocks that it triggers,
+ * the last ones as timing flows.  A port of an invoked module flows into
+ * everything that its instances define.  Like reach_index_t, instances are
+ * crossed through all of their connections, so a port reported here may be
+ * missing from the backward query of that port, but never the other way
+ * around.
+ */
+class forward_analysis_t {
+  private:
+    typedef std::pair<module_t*, symbol_t> item_t;
+
+    struct item_hash_t {
+        size_t operator()(const item_t& item) const {
+            return std::hash<module_t*>()(item.first) * 31 + item.second;
+        }
+    };
+
+    // Lattice value of a reached pair, and the bits not yet propagated.
+    typedef struct {
+        state_t value;
+        state_t pending;
+    } node_t;
+
+    typedef std::unordered_map<item_t, node_t, item_hash_t> node_map_t;
+    typedef std::pair<item_t, state_t> typed_item_t;
+
+    id_set_t timing_flows;
+    id_set_t non_timing_flows;
+
+    uint64_t instr_count;
+
+    // Limits of the query, if any, and the count of pairs it reached.
+    query_budget_t* budget;
+    uint64_t reached_count;
+
+    // Nets at which the query stops, if any, and the queried pair.
+    cut_set_t* cuts;
+    module_t* root_module;
+    symbol_t root_id;
+
+    // Registers that the query may cross, or util_t::k_no_index, the
+    // registers crossed so far, and the pairs reached by crossing one more
+    // (see dep_analysis_t::use_cycle_bound()).
+    uint32_t cycle_bound;
+    uint32_t cycle;
+    std::vector<typed_item_t> next_cycle;
+    std::vector<std::pair<uint32_t, state_t> > graph_next_cycle;
+
+    // Compiled flow graph, if any, and the state of a query over it.
+    flow_graph_t* graph;
+    std::vector<node_t> graph_nodes;
+    index_list_t graph_workset;
+
+    node_map_t nodes;
+    std::vector<item_t> workset;
+    module_map_t* modules;
+
+    bool cut(module_t*, symbol_t);
+    void add_flow(module_t*, symbol_t, state_t);
+    void add_defined_ids(instr_t*, state_t, bool);
+    void add_block_defs(module_t*, uint32_t, state_t, bool);
+    void expand_flow(module_t*, symbol_t, state_t);
+    void run_worklist();
+    void compute_full_flows(module_t*, symbol_t);
+
+    void add_graph_node(uint32_t, state_t);
+    void run_graph_worklist();
+    void compute_graph_flows(uint32_t);
+
+  public:
+    forward_analysis_t();
+
+    // disable copy constructor.
+    forward_analysis_t(const forward_analysis_t&) = delete;
+
+    void use_graph(flow_graph_t*);
+    void use_budget(query_budget_t*);
+    void use_cuts(cut_set_t*);
+    void use_cycle_bound(uint32_t);
+    bool truncated();
+    uint64_t visited_instrs();
+    id_set_t& timing_sinks();
+    id_set_t& non_timing_sinks();
+    bool compute_flows(identifier_t, identifier_t, module_map_t&);
+};
+
+#endif  // FORWARD_H_
@@ -0,0 +1,108 @@
+#ifndef MULTI_H_
+#define MULTI_H_
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "cut.h"
+#include "dependence.h"
+#include "structs.h"
+
+class query_cache_t;
+
+/*!
+ * Engine that answers up to 64 queries with a single backward traversal.
+ *
+ * Every (module, identifier) pair carries one bit per query and dependence
+ * type: whether the query has reached it as an ordinary or a timing
+ * dependence, and which of these bits are pending.  The pairs are popped from
+ * one worklist in the order of the sequential engine (see dep_analysis_t),
+ * and every expansion is applied to all pending queries at once with bitwise
+ * operations.  Since each query's bits evolve exactly as its own worklist
+ * would, the results of every query are identical to those of dep_analysis_t.
+ */
+class multi_dep_analysis_t {
+  public:
+    static const uint32_t k_max_queries = 64;
+
+  private:
+    typedef uint64_t mask_t;
+    typedef std::pair<module_t*, symbol_t> item_t;
+
+    typedef struct {
+        mask_t ordinary;
+        mask_t timing;
+        mask_t pending_ordinary;
+        mask_t pending_timing;
+    } node_t;
+
+    typedef struct {
+        mask_t ordinary;
+        mask_t timing;
+    } port_masks_t;
+
+    // Queries in which a module instance has been expanded, per type.
+    typedef struct {
+        mask_t ordinary;
+        mask_t timing;
+        module_t* invoked_ds;
+    } invoke_masks_t;
+
+    typedef std::unordered_map<invoke_t*, invoke_masks_t> invoke_mask_map_t;
+
+    typedef struct {
+        module_t* module_ds;
+        symbol_t id;
+
+        id_set_t timing_deps;
+        id_set_t non_timing_deps;
+        uint64_t instr_count;
+    } query_t;
+
+    typedef std::unordered_map<item_t, node_t,
+            dep_analysis_t::item_hash_t> node_map_t;
+
+    std::vector<query_t> queries;
+    std::set<item_t> workset;
+    node_map_t nodes;
+    std::unordered_map<symbol_t, port_masks_t> ports;
+    std::unordered_map<module_t*, invoke_mask_map_t> invokes;
+
+    // Nets at which the queries stop, if any.
+    cut_set_t* cuts;
+
+    // Expansions shared with other queries, if any.
+    query_cache_t* cache;
+    uint64_t cache_generation;
+
+    dep_analysis_t::expansion_t scratch;
+    uint64_t instr_count;
+
+    void add_new_id(module_t*, symbol_t, mask_t, bool);
+    mask_t blocked(module_t*, symbol_t);
+    mask_t seen(module_t*, symbol_t);
+    void taint_connections(module_t*, symbol_t, mask_t);
+    void gather_inter_module_dependencies(invoke_t*, mask_t, mask_t,
+            module_map_t&);
+    void apply_expansion(dep_analysis_t::expansion_t&, mask_t, mask_t,
+            module_map_t&);
+    dep_analysis_t::expansion_t& find_expansion(item_t&,
+            std::shared_ptr<dep_analysis_t::expansion_t>&);
+
+  public:
+    multi_dep_analysis_t();
+
+    void use_cache(query_cache_t*);
+    void use_cuts(cut_set_t*);
+    bool add_query(identifier_t, identifier_t, module_map_t&);
+    void compute_dependencies(module_map_t&);
+
+    size_t size();
+    uint64_t visited_instrs();
+    uint64_t visited_instrs(size_t);
+    id_set_t& leaking_timing_deps(size_t);
+    id_set_t& leaking_non_timing_deps(size_t);
+};
+
+#endif  // MULTI_H_
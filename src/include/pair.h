@@ -0,0 +1,78 @@
+#ifndef PAIR_H_
+#define PAIR_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "budget.h"
+#include "cut.h"
+#include "flow.h"
+#include "reach.h"
+#include "structs.h"
+
+/*!
+ * Engine that checks whether a source identifier leaks into a sink.
+ *
+ * The search runs on the flow graph from both ends at once: backward from
+ * the sink over the edges of the graph, and forward from the source over
+ * the reversed edges, one level of the smaller frontier at a time.  Every
+ * node carries the types with which each side reached it, i.e. whether the
+ * path to it crossed a timing edge.  A node reached by both sides closes a
+ * path, which is a timing leak if either half crossed a timing edge.  The
+ * search stops once both types are found, or once either frontier is
+ * exhausted.
+ *
+ * Instances are crossed through all of their connections (see
+ * reach_index_t), whose answer is used instead if both ends are indexed
+ * ports and no nets are cut.  A path through a cut net (see cut_set_t)
+ * only counts if the net is one of its ends.
+ */
+class pair_analysis_t {
+  private:
+    typedef std::unordered_map<uint32_t, state_t> side_map_t;
+
+    typedef struct {
+        uint32_t node;
+        state_t type;
+    } frontier_item_t;
+
+    typedef std::vector<frontier_item_t> frontier_t;
+
+    flow_graph_t* graph;
+    reach_index_t* index;
+    query_budget_t* budget;
+    cut_set_t* cuts;
+    uint32_t source_node, sink_node;
+
+    side_map_t backward, forward;
+    frontier_t backward_frontier, forward_frontier;
+
+    state_t leaks;
+    uint64_t node_count;
+    bool from_index;
+
+    bool cut(uint32_t);
+    void add_node(side_map_t&, side_map_t&, frontier_t&, uint32_t, state_t);
+    bool expand_backward(frontier_t&);
+    bool expand_forward(frontier_t&);
+    void search(uint32_t, uint32_t);
+
+  public:
+    pair_analysis_t();
+
+    // disable copy constructor.
+    pair_analysis_t(const pair_analysis_t&) = delete;
+
+    void use_graph(flow_graph_t*);
+    void use_index(reach_index_t*);
+    void use_budget(query_budget_t*);
+    void use_cuts(cut_set_t*);
+    bool truncated();
+    bool answered_by_index();
+    uint64_t visited_nodes();
+    state_t leak_types();
+    bool compute_pair(identifier_t, identifier_t, identifier_t, identifier_t,
+            module_map_t&);
+};
+
+#endif  // PAIR_H_
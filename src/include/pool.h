@@ -0,0 +1,51 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * Fixed set of worker threads that run submitted tasks in FIFO order.
+ *
+ * A pool of size 1 runs tasks on a single worker thread; callers that want
+ * strictly serial behavior should simply not use a pool.
+ */
+class thread_pool_t {
+  private:
+    typedef std::function<void()> task_t;
+
+    std::vector<std::thread> workers;
+    std::deque<task_t> tasks;
+
+    std::mutex lock;
+    std::condition_variable task_ready;
+    std::condition_variable tasks_done;
+
+    uint32_t pending;
+    bool stopping;
+
+    void run_worker();
+
+  public:
+    explicit thread_pool_t(uint32_t);
+    ~thread_pool_t();
+
+    // disable copy constructor.
+    thread_pool_t(const thread_pool_t&) = delete;
+
+    uint32_t size();
+    void wait();
+    void submit(task_t);
+    void parallel_for(size_t, std::function<void(size_t)>);
+
+    static uint32_t default_size();
+};
+
+#endif  // POOL_H_
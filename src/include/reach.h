@@ -0,0 +1,82 @@
+#ifndef REACH_H_
+#define REACH_H_
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flow.h"
+#include "pool.h"
+#include "structs.h"
+
+class snapshot_reader_t;
+class snapshot_writer_t;
+
+/*!
+ * Precomputed transitive closure of the port-level dependence graph.
+ *
+ * Every port of every module is a node in two layers: reached as an
+ * ordinary dependence, and reached as a timing dependence.  Edges follow the
+ * flow graph of the design (see flow_graph_t), with paths through non-port
+ * identifiers contracted into port-to-port edges.  The graph is
+ * condensed into strongly connected components with Tarjan's algorithm, and
+ * every component stores a bitset of the components that it reaches.
+ *
+ * Queries take a port, so they answer in time proportional to the size of
+ * the answer.  Instances are crossed through all of their connections,
+ * whether or not a query would reach the connected identifiers, so the index
+ * may report more leaks than dep_analysis_t, but never fewer.
+ */
+class reach_index_t {
+  private:
+    typedef std::pair<module_t*, symbol_t> item_t;
+
+    struct item_hash_t {
+        size_t operator()(const item_t& item) const {
+            return std::hash<module_t*>()(item.first) * 31 + item.second;
+        }
+    };
+
+    typedef std::unordered_map<item_t, uint32_t, item_hash_t> item_map_t;
+
+    // Ports; node (2 * index + layer) is a port in the ordinary (0) or the
+    // timing (1) layer.
+    std::vector<item_t> ports;
+    item_map_t port_index;
+
+    // Component of every node, and the nodes of every component.
+    index_list_t components;
+    csr_t members;
+    uint32_t component_count;
+
+    // Reached components, 'words' 64-bit words per component.
+    std::vector<uint64_t> closure;
+    uint32_t words;
+
+    void add_port(module_t*, symbol_t);
+    void build_members();
+    bool reached(uint32_t, uint32_t);
+
+    void build_port_graph(flow_graph_t&, thread_pool_t*, adj_list_t&);
+    void build_components(csr_t&);
+    void build_closure(csr_t&);
+
+  public:
+    reach_index_t();
+
+    // disable copy constructor.
+    reach_index_t(const reach_index_t&) = delete;
+
+    void build(flow_graph_t&, thread_pool_t*);
+    bool contains(module_t*, symbol_t);
+    state_t leaks(module_t*, symbol_t, module_t*, symbol_t);
+    bool trace(module_t*, symbol_t, id_set_t&, id_set_t&);
+
+    size_t size();
+    size_t bytes();
+
+    void write_snapshot(snapshot_writer_t&);
+    bool read_snapshot(snapshot_reader_t&, module_map_t&);
+};
+
+#endif  // REACH_H_
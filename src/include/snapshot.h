@@ -0,0 +1,91 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <string>
+
+#include "reach.h"
+#include "structs.h"
+
+/*!
+ * Encoder for the payload of a design snapshot (see snapshot_t).
+ *
+ * Values are written in native byte order; symbols are written as the
+ * indices of the symbol table stored at the start of the payload.
+ */
+class snapshot_writer_t {
+  private:
+    std::string buffer;
+
+  public:
+    void put_u8(uint8_t);
+    void put_u32(uint32_t);
+    void put_string(const identifier_t&);
+    void put_ids(id_set_t&);
+    void put_ids(id_list_t&);
+    void put_indices(index_list_t&);
+
+    std::string& data();
+};
+
+/*!
+ * Decoder for the payload of a design snapshot.
+ *
+ * Reads past the end of the payload set a sticky error flag (see ok()) and
+ * return zeros instead of failing immediately.  Symbols are translated to
+ * the symbols of the running process.
+ */
+class snapshot_reader_t {
+  private:
+    const char* cursor;
+    const char* limit;
+    bool failed;
+
+    id_list_t symbols;
+
+    bool reserve(size_t);
+
+  public:
+    explicit snapshot_reader_t(const char*, size_t);
+
+    bool ok();
+    void invalidate();
+    void read_symbols();
+
+    uint8_t get_u8();
+    uint32_t get_u32();
+    uint32_t get_index(uint32_t);
+    symbol_t get_symbol();
+    identifier_t get_string();
+    void get_ids(id_set_t&);
+    void get_ids(id_list_t&);
+    void get_indices(index_list_t&, uint32_t);
+};
+
+/*!
+ * Versioned, checksummed binary file with the fully linked IR of a design.
+ *
+ * The file holds a fixed header (magic, version, payload size and CRC-32 of
+ * the payload), followed by the symbol table and every module's blocks,
+ * instructions (kinds, def and use sets, connections) and dominator data,
+ * and optionally by a reachability index of the design (see reach_index_t).
+ * Loading maps the file into memory and does not need Verific.
+ */
+class snapshot_t {
+  private:
+    static const char k_magic[8];
+
+    typedef struct {
+        char magic[8];
+        uint32_t version;
+        uint32_t checksum;
+        uint64_t payload_size;
+    } header_t;
+
+  public:
+    static const uint32_t k_version = 2;
+
+    static bool save(const identifier_t&, module_map_t&, reach_index_t*);
+    static bool load(const identifier_t&, module_map_t&, reach_index_t*&);
+};
+
+#endif  // SNAPSHOT_H_
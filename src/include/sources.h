@@ -0,0 +1,39 @@
+#ifndef SOURCES_H_
+#define SOURCES_H_
+
+#include <map>
+
+#include "structs.h"
+
+/*!
+ * Source files of a design, with a checksum of their contents and the names
+ * of the modules that each of them defines.
+ *
+ * Used to find the files that changed since they were analyzed, and the
+ * modules that have to be rebuilt because of that.
+ */
+class source_table_t {
+  private:
+    typedef struct {
+        uint32_t checksum;
+        name_list_t modules;
+    } source_t;
+
+    typedef std::map<identifier_t, source_t> source_map_t;
+
+    source_map_t sources;
+
+  public:
+    bool add_file(const identifier_t&);
+    void add_module(const identifier_t&, const identifier_t&);
+    void clear_modules(const identifier_t&);
+    void changed_files(name_list_t&);
+
+    bool contains(const identifier_t&);
+    name_list_t& modules(const identifier_t&);
+    size_t size();
+
+    static bool checksum(const identifier_t&, uint32_t&);
+};
+
+#endif  // SOURCES_H_
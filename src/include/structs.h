@@ -2,43 +2,69 @@
 #ifndef STRUCTS_H_
 #define STRUCTS_H_
 
+#include <atomic>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include <stdint.h>
 
 #include <VeriStatement.h>
 
+#include "arena.h"
+
 using namespace Verific;
 
 class bb_t;
 class instr_t;
+class invoke_t;
 class pinstr_t;
 class module_t;
+class snapshot_reader_t;
+class snapshot_writer_t;
 
 typedef uint8_t state_t;
+typedef uint32_t symbol_t;
 typedef std::string identifier_t;
 
 typedef std::set<bb_t*> bb_set_t;
 typedef std::set<instr_t*> instr_set_t;
-typedef std::set<identifier_t> id_set_t;
+typedef std::set<symbol_t> id_set_t;
 
 typedef std::list<bb_t*> bb_list_t;
 typedef std::list<instr_t*> instr_list_t;
-typedef std::vector<identifier_t> id_list_t;
+typedef std::vector<invoke_t*> invoke_list_t;
+typedef std::vector<symbol_t> id_list_t;
+typedef std::vector<identifier_t> name_list_t;
+
+typedef std::vector<uint32_t> index_list_t;
+typedef std::vector<index_list_t> adj_list_t;
 
 typedef std::map<identifier_t, module_t*> module_map_t;
 
 typedef struct {
     state_t state;
     id_set_t id_set;
-    identifier_t remote_endpoint;
+    symbol_t remote_endpoint;
 } conn_t;
 
 typedef std::list<conn_t> conn_list_t;
 
+// Definition or use of an identifier of another module by an instruction,
+// recorded while resolving module instantiations.
+typedef struct {
+    module_t* module_ds;
+    symbol_t id;
+    instr_t* instr;
+    bool def;
+} link_t;
+
+typedef std::vector<link_t> link_list_t;
+
 enum {
     STATE_UNKNOWN = 0,
     STATE_DEF,
@@ -56,13 +82,142 @@ enum {
     BB_HIDDEN,
 };
 
+enum {
+    INSTR_PARAM = 0,
+    INSTR_TRIGGER,
+    INSTR_STMT,
+    INSTR_ASSIGN,
+    INSTR_INVOKE,
+    INSTR_CMPR,
+    INSTR_PROC_CALL,
+    INSTR_PROC_DECL,
+    INSTR_DATA_DECL,
+};
+
+// Bits of the lattice of dependence types: an identifier may be reached as an
+// ordinary dependence, as a timing dependence, or as both.
+enum {
+    DEP_TIMING   = 1,
+    DEP_ORDINARY = 2,
+    DEP_BOTH     = 3,
+};
+
 typedef struct {
-    identifier_t name;
+    symbol_t name;
     state_t type;
 } id_desc_t;
 
 typedef std::list<id_desc_t> id_desc_list_t;
 
+/*!
+ * Design-wide symbol table.
+ *
+ * The analysis core refers to identifiers by dense 32-bit symbols, so that
+ * def/use lookups and dependence comparisons do not touch strings.  Names are
+ * only materialized again when printing results.
+ *
+ * The table is append-only, so queries running on several threads look up
+ * names and already-interned symbols without locking.  Names live in chunks
+ * that double in size and never move, and symbols are found through an
+ * open-addressing index of (symbol + 1) slots.  Only interning a new name
+ * takes the lock; a lookup that misses takes it too and checks again, since
+ * the name may have been added, or the index replaced, in the meantime.
+ */
+class symtab_t {
+  private:
+    // The first chunk holds 2^k_first_chunk_bits names, and every chunk
+    // holds as many names as all the previous ones together.
+    static const uint32_t k_first_chunk_bits = 10;
+    static const uint32_t k_chunk_count = 33 - k_first_chunk_bits;
+
+    typedef struct {
+        uint32_t mask;
+        std::unique_ptr<std::atomic<uint32_t>[]> slots;
+    } index_t;
+
+    // Serializes writers; readers only load the atomics below.
+    static std::mutex lock;
+    static std::atomic<identifier_t*> chunks[k_chunk_count];
+    static std::atomic<uint32_t> count;
+    static std::atomic<index_t*> index;
+
+    // Indices replaced by larger ones, which readers may still probe.
+    static std::vector<std::unique_ptr<index_t> > indices;
+
+    static uint64_t position(symbol_t);
+    static identifier_t& slot(symbol_t);
+    static symbol_t find(index_t*, const identifier_t&);
+    static void insert(index_t*, symbol_t);
+    static void grow();
+
+  public:
+    static symbol_t intern(const identifier_t&);
+    static const identifier_t& name(symbol_t);
+    static uint32_t size();
+};
+
+/*!
+ * Adjacency lists of a graph over dense node indices, in compressed sparse row
+ * form: the neighbors of node 'idx' are targets[offsets[idx] .. offsets[idx +
+ * 1]).
+ */
+class csr_t {
+  private:
+    index_list_t offsets;
+    index_list_t targets;
+
+  public:
+    /*!
+     * Contiguous range of neighbor indices, usable in range-based loops.
+     */
+    class range_t {
+      private:
+        const uint32_t* first;
+        const uint32_t* last;
+
+      public:
+        range_t(const uint32_t* __first, const uint32_t* __last)
+            : first(__first), last(__last) {}
+
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        uint32_t size() const { return last - first; }
+    };
+
+    void build(adj_list_t&);
+    void transpose(csr_t&);
+
+    uint32_t size();
+    range_t operator[](uint32_t);
+};
+
+/*!
+ * Frozen control-flow graph of a module.
+ *
+ * Built once, after the module's basic blocks are constructed.  Blocks are
+ * identified by bb_t::index(); successors are stored left first.  The block
+ * type and the entry block of each block are kept in parallel arrays.
+ */
+class cfg_t {
+  private:
+    csr_t succs, preds;
+    index_list_t roots;
+    index_list_t entries;
+    std::vector<state_t> types;
+
+  public:
+    void build(std::vector<bb_t*>&);
+
+    uint32_t size();
+    index_list_t& entry_blocks();
+    csr_t& successors();
+    csr_t& predecessors();
+
+    state_t block_type(uint32_t);
+    uint32_t entry_block(uint32_t);
+    void reachable_set(uint32_t, index_list_t&);
+};
+
 /*!
  * Instruction (abstract) class.
  */
@@ -71,6 +226,7 @@ class instr_t {
     typedef std::list<pinstr_t*> pinstr_list_t;
 
     bb_t* containing_bb;
+    state_t instr_kind;
     pinstr_list_t pinstrs;
 
   protected:
@@ -80,17 +236,18 @@ class instr_t {
     void parse_expression(VeriExpression*, state_t);
 
   public:
-    instr_t(bb_t*);
+    instr_t(bb_t*, state_t);
     instr_t(const instr_t&) = delete;
 
     ~instr_t();
 
     bb_t* parent();
+    state_t kind();
     id_set_t& defs();
     id_set_t& uses();
 
-    void add_def(identifier_t);
-    void add_use(identifier_t);
+    void add_def(symbol_t);
+    void add_use(symbol_t);
 
     virtual void dump() = 0;
     virtual bool operator==(const instr_t&) = 0;
@@ -101,11 +258,11 @@ class instr_t {
  */
 class param_t : public instr_t {
   private:
-    identifier_t param_name;
+    symbol_t param_name;
 
   public:
     param_t(const param_t&) = delete;
-    explicit param_t(bb_t*, identifier_t);
+    explicit param_t(bb_t*, symbol_t);
 
     virtual void dump();
     virtual bool operator==(const instr_t&);
@@ -176,6 +333,7 @@ class invoke_t : public instr_t {
 
   public:
     explicit invoke_t(bb_t*, VeriInstId*, identifier_t);
+    explicit invoke_t(bb_t*, identifier_t, conn_list_t&);
 
     virtual void dump();
     identifier_t module_name();
@@ -260,6 +418,21 @@ class data_decl_t : public instr_t {
     virtual bool operator==(const instr_t&);
 };
 
+/*!
+ * Class that represents an instruction restored from a snapshot.
+ *
+ * Only the kind and the def and use sets of the instruction are kept, since
+ * the underlying Verific object is not available.
+ */
+class snapshot_instr_t : public instr_t {
+  public:
+    snapshot_instr_t(const snapshot_instr_t&) = delete;
+    explicit snapshot_instr_t(bb_t*, state_t);
+
+    virtual void dump();
+    virtual bool operator==(const instr_t&);
+};
+
 /*!
  * Class that represents a nested statement, by just being a wrapper for a set
  * of basic blocks.
@@ -283,6 +456,7 @@ class pinstr_t {
 class bb_t {
   private:
     bb_t* entry_bb;
+    uint32_t bb_index;
     state_t bb_type;
     identifier_t bb_name;
     bb_set_t predecessors;
@@ -295,7 +469,7 @@ class bb_t {
     bool add_predecessor(bb_t*);
 
   public:
-    explicit bb_t(module_t*, const identifier_t&, state_t);
+    explicit bb_t(module_t*, const identifier_t&, state_t, uint32_t);
     ~bb_t();
 
     // disable copy constructor.
@@ -307,6 +481,7 @@ class bb_t {
     bool set_right_successor(bb_t*&);
 
     bb_set_t& preds();
+    uint32_t index();
     module_t* parent();
     identifier_t name();
     cmpr_t* comparison();
@@ -335,53 +510,87 @@ class module_t {
     typedef std::map<bb_t*, bb_t*> bb_map_t;
     typedef std::map<bb_t*, bb_set_t> bb_set_map_t;
     typedef std::map<identifier_t, uint32_t> bb_id_map_t;
-    typedef std::map<identifier_t, instr_set_t> id_map_t;
-    typedef std::map<identifier_t, state_t> id_state_map_t;
+    typedef std::unordered_map<symbol_t, instr_set_t> id_map_t;
+    typedef std::unordered_map<symbol_t, state_t> id_state_map_t;
+    typedef std::unordered_map<symbol_t, symbol_t> id_symbol_map_t;
+    typedef std::unordered_map<symbol_t, index_list_t> id_index_map_t;
     typedef std::map<identifier_t, proc_decl_t*> proc_decl_map_t;
 
+    // Owns every basic block and instruction of this module, including
+    // BB_HIDDEN blocks that are not part of 'basicblocks'.
+    arena_t ir_arena;
+
     bool primitive;
-    bool empty_dominators;
+
+    // Dominators are built lazily, possibly by concurrent queries.
+    std::mutex dominator_lock;
+    std::atomic<bool> empty_dominators;
     identifier_t mod_name;
     instance_set_t instance_set;
 
     bb_id_map_t bb_id_map;
     bb_list_t basicblocks;
-    bb_set_map_t dominators;
     bb_set_t top_level_blocks;
-    bb_set_map_t postdominators;
-
-    bb_map_t imm_dominator;
-    bb_map_t imm_postdominator;
+    std::vector<bb_t*> bb_table;
+    cfg_t flow_graph;
+
+    // Indexed by bb_t::index().  The postdominator forest is numbered with
+    // DFS pre/post intervals so that postdominates() is a range check.
+    index_list_t imm_dominator;
+    index_list_t imm_postdominator;
+    index_list_t pdom_pre, pdom_post;
+
+    // Per-block dependence summaries (see build_block_summaries()), also
+    // indexed by bb_t::index().  'imm_guard' is the nearest block that the
+    // block is control dependent on.
+    index_list_t imm_guard;
+    std::vector<id_list_t> implicit_ids;
+    std::vector<id_list_t> trigger_ids;
+
+    // The same summaries inverted, for forward queries: the blocks that an
+    // identifier guards, and the blocks of the 'always' blocks it triggers.
+    id_index_map_t guarded_blocks;
+    id_index_map_t triggered_blocks;
 
     id_map_t def_map;
     id_map_t use_map;
     id_set_t arg_ports;
     id_state_map_t arg_states;
+    id_symbol_map_t qualified_ports;
 
     proc_decl_map_t proc_decls;
+    invoke_list_t invoke_list;
 
-    state_t arg_state(identifier_t);
     void intersect(bb_set_t&, bb_set_t&);
-    bool update_dominators(bb_t*, bb_set_t&);
-    bool update_postdominators(bb_t*, bb_set_t&);
+    bool update_dominators(bb_t*, bb_set_t&, bb_set_map_t&);
+    bool update_postdominators(bb_t*, bb_set_t&, bb_set_map_t&);
     void augment_chains_with_links(module_map_t&);
-    bool process_connection(conn_t&, invoke_t*, module_t*);
+    bool process_connection(conn_t&, invoke_t*, module_t*, link_list_t&);
 
     void process_module_items(Array*);
     void process_module_ports(Array*);
     void process_module_params(Array*);
     void process_module_item(VeriModuleItem*);
 
-    bb_t* find_imm_dominator(bb_t*, bb_set_t&);
-    bb_t* find_imm_postdominator(bb_t*, bb_set_t&);
-
-    void add_arg(identifier_t, state_t);
-    void build_dominator_sets(bb_set_t&);
-    void update_arg(identifier_t, state_t);
-    void resolve_invoke(invoke_t*, module_map_t&);
+    bb_t* find_imm_dominator(bb_t*, bb_set_t&, bb_set_map_t&);
+    bb_t* find_imm_postdominator(bb_t*, bb_set_t&, bb_set_map_t&);
+
+    void add_arg(symbol_t, state_t);
+    void add_port(symbol_t, state_t);
+    void freeze_cfg();
+    void number_postdominator_tree();
+    void build_block_summaries();
+    void invert_block_summaries();
+    void build_dominator_trees(bool);
+    bool postdominates(uint32_t, uint32_t);
+    void build_dominator_sets(bb_set_t&, bb_map_t&, bb_map_t&);
+    void update_arg(symbol_t, state_t);
+    void resolve_invoke(invoke_t*, module_map_t&, link_list_t&);
+    void remove_instr(id_map_t&, symbol_t, instr_t*);
 
   public:
     explicit module_t(VeriModule*&);
+    explicit module_t(snapshot_reader_t&);
     ~module_t();
 
     // disable copy constructor.
@@ -390,28 +599,51 @@ class module_t {
     void dump();
     void print_undef_ids();
     void build_def_use_chains();
+    void write_snapshot(snapshot_writer_t&);
+
+    arena_t& arena();
+    cfg_t& cfg();
     void build_dominator_sets();
+    void warm_dominator_sets();
+    bool dominators_ready();
+    bool check_dominator_sets();
     void resolve_links(module_map_t&);
-    void add_def(identifier_t, instr_t*);
-    void add_use(identifier_t, instr_t*);
+    void resolve_links(module_map_t&, link_list_t&);
+    void add_links(link_list_t&);
+    void relink_invoke(invoke_t*, module_map_t&);
+    void unlink_invoke(invoke_t*, module_t*);
+    void add_def(symbol_t, instr_t*);
+    void add_use(symbol_t, instr_t*);
     void remove_from_top_level_blocks(bb_t*);
     void populate_guard_blocks(bb_t*, bb_set_t&);
     void process_statement(bb_t*&, VeriStatement*);
 
+    bb_t* block(uint32_t);
     bb_t* immediate_dominator(bb_t*);
     bb_t* immediate_postdominator(bb_t*);
     bb_t* create_empty_bb(identifier_t, state_t, bool);
 
+    id_list_t& implicit_flow_ids(bb_t*);
+    id_list_t& timing_trigger_ids(bb_t*);
+    bool clocked_block(bb_t*);
+    index_list_t& implicit_flow_blocks(symbol_t);
+    index_list_t& timing_trigger_blocks(symbol_t);
+
     id_set_t& ports();
+    state_t arg_state(symbol_t);
+    invoke_list_t& invokes();
     identifier_t name();
-    instr_set_t& def_instrs(identifier_t);
-    instr_set_t& use_instrs(identifier_t);
+    instr_set_t& def_instrs(symbol_t);
+    instr_set_t& use_instrs(symbol_t);
+    symbol_t qualified_port(symbol_t);
     proc_decl_t* proc_decl_by_id(identifier_t);
     identifier_t make_unique_bb_id(identifier_t);
 
     bool exists(bb_t*);
+    bool is_defined(symbol_t);
+    bool is_used(symbol_t);
     bool is_primitive();
-    bool port_exists(identifier_t);
+    bool port_exists(symbol_t);
     bool postdominates(bb_t* source, bb_t* sink);
 
     bool ignored_statement(VeriStatement*);
@@ -419,13 +651,26 @@ class module_t {
 };
 
 class util_t {
+  private:
+    // Every message is written under this lock, so that the messages of
+    // concurrent queries do not interleave.
+    static std::mutex output_lock;
+
+    static void write(const identifier_t&);
+
   public:
     static const identifier_t k_reset, k_yellow, k_red, k_warn, k_fatal,
             k_underline;
 
+    static const uint32_t k_no_index = UINT32_MAX;
+
+    // Progress messages are disabled while queries run concurrently.
+    static std::atomic<bool> show_status;
+
     static void clear_status();
     static void warn(identifier_t);
     static void dump_set(id_set_t&);
+    static void sorted_names(id_set_t&, name_list_t&);
     static void fatal(identifier_t);
     static void plain(identifier_t);
     static void underline(identifier_t);
@@ -438,6 +683,8 @@ class util_t {
     static bool sysverilog_statement(VeriStatement*);
 
     static uint64_t build_reachable_set(bb_t*&, bb_set_t&);
+    static void build_dominator_tree(csr_t&, csr_t&, index_list_t&,
+            index_list_t&);
 };
 
 #endif  // STRUCTS_H_
@@ -0,0 +1,99 @@
+#ifndef SUMMARY_H_
+#define SUMMARY_H_
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cut.h"
+#include "structs.h"
+
+/*!
+ * Port-to-port flow summaries of modules.
+ *
+ * For every output port of an instantiated module, the summary lists the
+ * input ports of the module that flow into it and the (qualified) ports that
+ * are reached on the way, including the ports of nested instances.  Queries
+ * then cross module instantiations by applying the summary of the invoked
+ * port, instead of descending into the body of the invoked module.
+ *
+ * Summaries are computed on demand: the first query in a module summarizes
+ * the modules that it (transitively) instantiates, one strongly connected
+ * component of the instantiation graph at a time.  Queries may run
+ * concurrently; a summarized component is never changed again, so only
+ * summarizing takes the lock.
+ */
+class summary_table_t {
+  public:
+    // Identifiers with the types (DEP_*) of their entries, which may be both.
+    typedef std::pair<symbol_t, state_t> typed_id_t;
+    typedef std::vector<typed_id_t> typed_id_list_t;
+
+    // Types are those seen when entering the traced port as an ordinary
+    // dependence; entering it as a timing dependence makes all of them timing.
+    typedef struct {
+        typed_id_list_t inputs;
+        typed_id_list_t ports;
+    } summary_t;
+
+  private:
+    typedef std::map<symbol_t, state_t> typed_id_map_t;
+    typedef std::unordered_map<symbol_t, summary_t> port_summary_map_t;
+    typedef std::unordered_map<module_t*, port_summary_map_t> summary_map_t;
+    typedef std::vector<module_t*> module_list_t;
+    typedef std::map<module_t*, module_list_t> call_graph_t;
+
+    // State of a single trace through one module.
+    typedef struct {
+        module_t* module_ds;
+        id_set_t workset;
+        typed_id_map_t seen;
+        typed_id_map_t ports;
+    } trace_state_t;
+
+    module_map_t& module_map;
+
+    // Every instantiated module has an entry, so that the map itself does
+    // not change while queries read it (see prepare()).
+    summary_map_t summaries;
+    call_graph_t call_graph;
+
+    // Modules whose summaries are final, guarded by 'lock'.
+    std::set<module_t*> complete;
+    std::mutex lock;
+
+    uint64_t summary_count;
+
+    module_t* invoked_module(invoke_t*);
+    summary_t* lookup(module_t*, symbol_t);
+
+    static state_t applied_type(state_t, state_t);
+
+    void add_port(trace_state_t&, symbol_t, state_t);
+    void add_new_id(trace_state_t&, symbol_t, state_t);
+    void apply_summary(trace_state_t&, invoke_t*, symbol_t, state_t);
+
+    void trace_module(module_t*, symbol_t, summary_t&, uint64_t&,
+            cut_set_t*);
+
+    void build_call_graph(module_list_t&);
+    bool summarize_module(module_t*);
+    void summarize_component(module_list_t&);
+    void require(module_t*);
+
+  public:
+    explicit summary_table_t(module_map_t&);
+
+    // disable copy constructor.
+    summary_table_t(const summary_table_t&) = delete;
+
+    void prepare();
+    void invalidate(std::set<identifier_t>&);
+    uint64_t size();
+    void trace(module_t*, symbol_t, summary_t&, uint64_t&, cut_set_t*);
+};
+
+#endif  // SUMMARY_H_
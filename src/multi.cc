@@ -0,0 +1,350 @@
+#include <cassert>
+
+#include "cache.h"
+#include "multi.h"
+
+multi_dep_analysis_t::multi_dep_analysis_t() {
+    cache = nullptr;
+    cache_generation = 0;
+    instr_count = 0;
+
+    cuts = nullptr;
+}
+
+/*! \brief reuse the expansions of earlier queries (see query_cache_t).
+ */
+void multi_dep_analysis_t::use_cache(query_cache_t* __cache) {
+    cache = __cache;
+}
+
+/*! \brief stop the queries at the nets of 'cuts' (see
+ * dep_analysis_t::use_cuts()).
+ */
+void multi_dep_analysis_t::use_cuts(cut_set_t* __cuts) {
+    cuts = __cuts;
+}
+
+/*! \brief add a query for the next compute_dependencies().
+ *
+ * Returns false if the engine already holds k_max_queries queries.
+ */
+bool multi_dep_analysis_t::add_query(identifier_t module_name,
+        identifier_t identifier, module_map_t& module_map) {
+    if (queries.size() == k_max_queries) {
+        return false;
+    }
+
+    module_map_t::iterator it = module_map.find(module_name);
+    assert(it != module_map.end() && "failed to find requested module!");
+
+    query_t query;
+    query.module_ds = it->second;
+    query.id = symtab_t::intern(identifier);
+    query.instr_count = 0;
+
+    queries.push_back(query);
+    return true;
+}
+
+/*! \brief queries in which a pair is cut, i.e. all but those that query it.
+ */
+multi_dep_analysis_t::mask_t multi_dep_analysis_t::blocked(
+        module_t* module_ds, symbol_t id) {
+    if (cuts == nullptr || cuts->contains(module_ds, id) == false) {
+        return 0;
+    }
+
+    mask_t roots = 0;
+
+    for (size_t idx = 0; idx < queries.size(); idx++) {
+        if (queries[idx].module_ds == module_ds && queries[idx].id == id) {
+            roots |= (mask_t) 1 << idx;
+        }
+    }
+
+    return ~roots;
+}
+
+/*! \brief queries that have reached a pair, with any type, and in which it
+ * is not cut.
+ */
+multi_dep_analysis_t::mask_t multi_dep_analysis_t::seen(module_t* module_ds,
+        symbol_t id) {
+    node_map_t::iterator it = nodes.find(item_t(module_ds, id));
+
+    if (it == nodes.end()) {
+        return 0;
+    }
+
+    return (it->second.ordinary | it->second.timing) &
+        ~blocked(module_ds, id);
+}
+
+/*! \brief reach a pair in the queries of 'mask', as a timing or an ordinary
+ * dependence.
+ *
+ * Like dep_analysis_t::add_new_id(), only queries that have not reached the
+ * pair with that type yet are affected.
+ */
+void multi_dep_analysis_t::add_new_id(module_t* module_ds, symbol_t id,
+        mask_t mask, bool timing) {
+    if (mask == 0) {
+        return;
+    }
+
+    item_t item(module_ds, id);
+    node_t& node = nodes[item];
+
+    mask_t new_mask = mask & ~(timing ? node.timing : node.ordinary);
+
+    if (new_mask == 0) {
+        return;
+    }
+
+    mask_t first_seen = new_mask & ~(node.ordinary | node.timing);
+
+    if (module_ds->port_exists(id)) {
+        port_masks_t& port = ports[module_ds->qualified_port(id)];
+
+        if (timing) {
+            port.timing |= new_mask;
+        } else {
+            port.ordinary |= new_mask;
+        }
+    }
+
+    if (timing) {
+        node.timing |= new_mask;
+        node.pending_timing |= new_mask;
+    } else {
+        node.ordinary |= new_mask;
+        node.pending_ordinary |= new_mask;
+    }
+
+    workset.insert(item);
+
+    first_seen &= ~blocked(module_ds, id);
+
+    if (first_seen != 0) {
+        taint_connections(module_ds, id, first_seen);
+    }
+}
+
+/*! \brief taint the ports connected to an identifier that the queries of
+ * 'mask' reached for the first time, in the instances they have expanded.
+ */
+void multi_dep_analysis_t::taint_connections(module_t* module_ds,
+        symbol_t id, mask_t mask) {
+    auto it = invokes.find(module_ds);
+
+    if (it == invokes.end()) {
+        return;
+    }
+
+    for (auto& entry : it->second) {
+        invoke_masks_t& masks = entry.second;
+
+        for (conn_t& connection : entry.first->connections()) {
+            if (connection.id_set.find(id) == connection.id_set.end()) {
+                continue;
+            }
+
+            add_new_id(masks.invoked_ds, connection.remote_endpoint,
+                    mask & masks.ordinary, false);
+            add_new_id(masks.invoked_ds, connection.remote_endpoint,
+                    mask & masks.timing, true);
+        }
+    }
+}
+
+void multi_dep_analysis_t::gather_inter_module_dependencies(invoke_t* invoke,
+        mask_t ordinary, mask_t timing, module_map_t& module_map) {
+    module_map_t::iterator it = module_map.find(invoke->module_name());
+    assert(it != module_map.end() && "failed to find invoked module!");
+
+    module_t* module_ds = it->second;
+    module_t* caller_ds = invoke->parent()->parent();
+
+    invoke_masks_t& masks = invokes[caller_ds][invoke];
+
+    ordinary &= ~masks.ordinary;
+    timing &= ~masks.timing;
+
+    if ((ordinary | timing) == 0) {
+        return;
+    }
+
+    masks.ordinary |= ordinary;
+    masks.timing |= timing;
+    masks.invoked_ds = module_ds;
+
+    // A port of the callee is tainted in the queries that have seen any of
+    // the identifiers connected to it.
+    std::vector<std::pair<symbol_t, mask_t> > new_taints;
+
+    for (conn_t& connection : invoke->connections()) {
+        mask_t tainted = 0;
+
+        for (symbol_t id : connection.id_set) {
+            tainted |= seen(caller_ds, id);
+        }
+
+        tainted &= ordinary | timing;
+
+        if (tainted != 0) {
+            new_taints.push_back(std::make_pair(connection.remote_endpoint,
+                        tainted));
+        }
+    }
+
+    for (auto& taint : new_taints) {
+        add_new_id(module_ds, taint.first, taint.second & ordinary, false);
+        add_new_id(module_ds, taint.first, taint.second & timing, true);
+    }
+}
+
+void multi_dep_analysis_t::apply_expansion(
+        dep_analysis_t::expansion_t& expansion, mask_t ordinary,
+        mask_t timing, module_map_t& module_map) {
+    for (dep_analysis_t::step_t& step : expansion.steps) {
+        switch (step.kind) {
+            case dep_analysis_t::STEP_SAME_TYPE:
+            case dep_analysis_t::STEP_IMPLICIT:
+                add_new_id(step.module_ds, step.id, ordinary, false);
+                add_new_id(step.module_ds, step.id, timing, true);
+                break;
+
+            case dep_analysis_t::STEP_TIMING:
+                add_new_id(step.module_ds, step.id, ordinary | timing, true);
+                break;
+
+            case dep_analysis_t::STEP_INVOKE:
+                gather_inter_module_dependencies(step.invoke, ordinary,
+                        timing, module_map);
+                break;
+        }
+    }
+}
+
+dep_analysis_t::expansion_t& multi_dep_analysis_t::find_expansion(
+        item_t& item, std::shared_ptr<dep_analysis_t::expansion_t>& pinned) {
+    if (cache == nullptr) {
+        dep_analysis_t::expand_dependence(item.first, item.second, scratch);
+        return scratch;
+    }
+
+    pinned = cache->find_expansion(item.first, item.second);
+
+    if (pinned == nullptr) {
+        pinned = std::make_shared<dep_analysis_t::expansion_t>();
+        dep_analysis_t::expand_dependence(item.first, item.second, *pinned);
+
+        cache->add_expansion(item.first, item.second, pinned,
+                cache_generation);
+    }
+
+    return *pinned;
+}
+
+/*! \brief analyze all added queries for leakage, in a single traversal.
+ */
+void multi_dep_analysis_t::compute_dependencies(module_map_t& module_map) {
+    workset.clear();
+    nodes.clear();
+    ports.clear();
+    invokes.clear();
+
+    instr_count = 0;
+
+    if (cache != nullptr) {
+        cache_generation = cache->generation();
+    }
+
+    util_t::update_status("tracing definitions ... ");
+
+    for (size_t idx = 0; idx < queries.size(); idx++) {
+        item_t item(queries[idx].module_ds, queries[idx].id);
+        node_t& node = nodes[item];
+
+        node.ordinary |= (mask_t) 1 << idx;
+        node.pending_ordinary |= (mask_t) 1 << idx;
+
+        workset.insert(item);
+    }
+
+    std::shared_ptr<dep_analysis_t::expansion_t> pinned;
+
+    // Each popped pair is the minimum of the worklist of every query that it
+    // is pending in, so every query visits its pairs in its sequential order.
+    while (workset.size() > 0) {
+        std::set<item_t>::iterator it = workset.begin();
+
+        item_t item = *it;
+        workset.erase(it);
+
+        node_t& node = nodes[item];
+        mask_t ordinary = node.pending_ordinary;
+        mask_t timing = node.pending_timing;
+
+        node.pending_ordinary = node.pending_timing = 0;
+
+        // Cut pairs are only expanded by the queries that asked for them.
+        mask_t cut = blocked(item.first, item.second);
+
+        ordinary &= ~cut;
+        timing &= ~cut;
+
+        if ((ordinary | timing) == 0) {
+            continue;
+        }
+
+        dep_analysis_t::expansion_t& expansion = find_expansion(item, pinned);
+        instr_count += expansion.instrs;
+
+        for (size_t idx = 0; idx < queries.size(); idx++) {
+            if (((ordinary | timing) >> idx) & 1) {
+                queries[idx].instr_count += expansion.instrs;
+            }
+        }
+
+        apply_expansion(expansion, ordinary, timing, module_map);
+    }
+
+    for (auto it = ports.begin(); it != ports.end(); it++) {
+        for (size_t idx = 0; idx < queries.size(); idx++) {
+            if ((it->second.timing >> idx) & 1) {
+                queries[idx].timing_deps.insert(it->first);
+            }
+
+            if ((it->second.ordinary >> idx) & 1) {
+                queries[idx].non_timing_deps.insert(it->first);
+            }
+        }
+    }
+}
+
+/*! \brief count of queries.
+ */
+size_t multi_dep_analysis_t::size() {
+    return queries.size();
+}
+
+/*! \brief count of instructions visited by the shared traversal.
+ */
+uint64_t multi_dep_analysis_t::visited_instrs() {
+    return instr_count;
+}
+
+/*! \brief count of instructions that query 'idx' alone would visit.
+ */
+uint64_t multi_dep_analysis_t::visited_instrs(size_t idx) {
+    return queries[idx].instr_count;
+}
+
+id_set_t& multi_dep_analysis_t::leaking_timing_deps(size_t idx) {
+    return queries[idx].timing_deps;
+}
+
+id_set_t& multi_dep_analysis_t::leaking_non_timing_deps(size_t idx) {
+    return queries[idx].non_timing_deps;
+}
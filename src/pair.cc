@@ -0,0 +1,262 @@
+#include <cassert>
+
+#include "pair.h"
+
+pair_analysis_t::pair_analysis_t() {
+    graph = nullptr;
+    index = nullptr;
+    budget = nullptr;
+    cuts = nullptr;
+    source_node = sink_node = flow_graph_t::k_no_node;
+
+    leaks = 0;
+    node_count = 0;
+    from_index = false;
+}
+
+/*! \brief search the compiled flow graph; required by compute_pair().
+ */
+void pair_analysis_t::use_graph(flow_graph_t* __graph) {
+    graph = __graph;
+}
+
+/*! \brief answer pairs of indexed ports from the reachability index.
+ */
+void pair_analysis_t::use_index(reach_index_t* __index) {
+    index = __index;
+}
+
+/*! \brief stop searches once 'budget' is exhausted (see
+ * dep_analysis_t::use_budget()).  A truncated search may miss leaks.
+ */
+void pair_analysis_t::use_budget(query_budget_t* __budget) {
+    budget = __budget;
+}
+
+/*! \brief stop searches at the nets of 'cuts' (see cut_set_t).
+ */
+void pair_analysis_t::use_cuts(cut_set_t* __cuts) {
+    cuts = __cuts;
+}
+
+/*! \brief check whether the last search ran out of budget.
+ */
+bool pair_analysis_t::truncated() {
+    return budget != nullptr &&
+        budget->exhausted_limit() != query_budget_t::LIMIT_NONE;
+}
+
+/*! \brief check whether a node other than the ends of the search is cut.
+ */
+bool pair_analysis_t::cut(uint32_t node) {
+    return cuts != nullptr && node != source_node && node != sink_node &&
+        cuts->contains(graph->module_of(node), graph->id_of(node));
+}
+
+/*! \brief raise the types with which one side reached a node, and check
+ * whether the other side reached it too.
+ *
+ * Cut nodes are skipped: a path through them is no path.
+ */
+void pair_analysis_t::add_node(side_map_t& side, side_map_t& other,
+        frontier_t& frontier, uint32_t node, state_t type) {
+    if (cut(node)) {
+        return;
+    }
+
+    state_t& value = side[node];
+    state_t new_type = type & ~value;
+
+    if (new_type == 0) {
+        return;
+    }
+
+    value |= new_type;
+    node_count += 1;
+
+    frontier_item_t item = { node, new_type };
+    frontier.push_back(item);
+
+    side_map_t::iterator it = other.find(node);
+
+    if (it == other.end()) {
+        return;
+    }
+
+    // Both halves are ordinary paths, or either crossed a timing edge.
+    if ((new_type & DEP_ORDINARY) && (it->second & DEP_ORDINARY)) {
+        leaks |= DEP_ORDINARY;
+    }
+
+    if ((new_type & DEP_TIMING) || (it->second & DEP_TIMING)) {
+        leaks |= DEP_TIMING;
+    }
+}
+
+/*! \brief expand one level of the search from the sink; false if the
+ * budget ran out.
+ */
+bool pair_analysis_t::expand_backward(frontier_t& next) {
+    for (frontier_item_t& item : backward_frontier) {
+        if (budget != nullptr && budget->charge(node_count) == false) {
+            return false;
+        }
+
+        for (uint32_t edge : graph->successors(item.node)) {
+            bool timing = (edge & 3) == flow_graph_t::EDGE_TIMING;
+
+            add_node(backward, forward, next, edge >> 3,
+                    timing ? (state_t) DEP_TIMING : item.type);
+        }
+
+        for (uint32_t instance_idx : graph->instances(item.node)) {
+            flow_graph_t::instance_t& instance = graph->instance(instance_idx);
+            uint32_t last = instance.first_connection +
+                instance.connection_count;
+
+            for (uint32_t conn_idx = instance.first_connection;
+                    conn_idx < last; conn_idx++) {
+                add_node(backward, forward, next,
+                        graph->connection(conn_idx).port, item.type);
+            }
+        }
+    }
+
+    return true;
+}
+
+/*! \brief expand one level of the search from the source; false if the
+ * budget ran out.
+ */
+bool pair_analysis_t::expand_forward(frontier_t& next) {
+    for (frontier_item_t& item : forward_frontier) {
+        if (budget != nullptr && budget->charge(node_count) == false) {
+            return false;
+        }
+
+        for (uint32_t edge : graph->predecessors(item.node)) {
+            bool timing = (edge & 3) == flow_graph_t::EDGE_TIMING;
+
+            add_node(forward, backward, next, edge >> 3,
+                    timing ? (state_t) DEP_TIMING : item.type);
+        }
+
+        for (uint32_t instance_idx : graph->instantiations(item.node)) {
+            for (uint32_t defined : graph->defined_nodes(instance_idx)) {
+                add_node(forward, backward, next, defined, item.type);
+            }
+        }
+    }
+
+    return true;
+}
+
+void pair_analysis_t::search(uint32_t source, uint32_t sink) {
+    frontier_t next;
+
+    source_node = source;
+    sink_node = sink;
+
+    add_node(backward, forward, backward_frontier, sink, DEP_ORDINARY);
+    add_node(forward, backward, forward_frontier, source, DEP_ORDINARY);
+
+    while (leaks != DEP_BOTH && backward_frontier.size() > 0 &&
+            forward_frontier.size() > 0) {
+        next.clear();
+
+        if (backward_frontier.size() <= forward_frontier.size()) {
+            if (expand_backward(next) == false) {
+                break;
+            }
+
+            backward_frontier.swap(next);
+        } else {
+            if (expand_forward(next) == false) {
+                break;
+            }
+
+            forward_frontier.swap(next);
+        }
+    }
+}
+
+/*! \brief whether the last pair was answered by the reachability index.
+ */
+bool pair_analysis_t::answered_by_index() {
+    return from_index;
+}
+
+/*! \brief count of (node, type) pairs reached by the last search.
+ */
+uint64_t pair_analysis_t::visited_nodes() {
+    return node_count;
+}
+
+/*! \brief types with which the source leaks into the sink, as DEP_TIMING and
+ * DEP_ORDINARY bits.
+ */
+state_t pair_analysis_t::leak_types() {
+    return leaks;
+}
+
+/*! \brief check whether a source identifier leaks into a sink identifier.
+ *
+ * Like a query on the sink, an identifier is not an ordinary leak of
+ * itself.  Returns true if the source leaks into the sink.
+ */
+bool pair_analysis_t::compute_pair(identifier_t source_module,
+        identifier_t source_id, identifier_t sink_module, identifier_t sink_id,
+        module_map_t& module_map) {
+    assert(graph != nullptr && "pair queries need a flow graph!");
+
+    backward.clear();
+    forward.clear();
+    backward_frontier.clear();
+    forward_frontier.clear();
+
+    leaks = 0;
+    node_count = 0;
+    from_index = false;
+
+    if (budget != nullptr) {
+        budget->start();
+    }
+
+    module_map_t::iterator source_it = module_map.find(source_module);
+    module_map_t::iterator sink_it = module_map.find(sink_module);
+
+    assert(source_it != module_map.end() && sink_it != module_map.end() &&
+            "failed to find requested module!");
+
+    module_t* source_ds = source_it->second;
+    module_t* sink_ds = sink_it->second;
+
+    symbol_t source = symtab_t::intern(source_id);
+    symbol_t sink = symtab_t::intern(sink_id);
+
+    if (index != nullptr && cuts == nullptr &&
+            index->contains(source_ds, source) &&
+            index->contains(sink_ds, sink)) {
+        leaks = index->leaks(sink_ds, sink, source_ds, source);
+        from_index = true;
+
+        return leaks != 0;
+    }
+
+    uint32_t source_node = graph->node(source_ds, source);
+    uint32_t sink_node = graph->node(sink_ds, sink);
+
+    if (source_node == flow_graph_t::k_no_node ||
+            sink_node == flow_graph_t::k_no_node) {
+        return false;
+    }
+
+    util_t::update_status("searching paths ... ");
+    search(source_node, sink_node);
+
+    if (source_node == sink_node) {
+        leaks &= ~DEP_ORDINARY;
+    }
+
+    return leaks != 0;
+}
@@ -0,0 +1,110 @@
+#include <atomic>
+#include <cassert>
+
+#include "pool.h"
+
+thread_pool_t::thread_pool_t(uint32_t thread_count) {
+    assert(thread_count > 0 && "empty thread pool!");
+
+    pending = 0;
+    stopping = false;
+
+    for (uint32_t idx = 0; idx < thread_count; idx++) {
+        workers.emplace_back(&thread_pool_t::run_worker, this);
+    }
+}
+
+/*! \brief finish all submitted tasks, then join the workers.
+ */
+thread_pool_t::~thread_pool_t() {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        stopping = true;
+    }
+
+    task_ready.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void thread_pool_t::run_worker() {
+    while (true) {
+        task_t task;
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            task_ready.wait(guard, [this] {
+                return stopping || tasks.size() > 0;
+            });
+
+            if (tasks.size() == 0) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            pending -= 1;
+
+            if (pending == 0) {
+                tasks_done.notify_all();
+            }
+        }
+    }
+}
+
+uint32_t thread_pool_t::size() {
+    return workers.size();
+}
+
+/*! \brief block until every submitted task has finished.
+ */
+void thread_pool_t::wait() {
+    std::unique_lock<std::mutex> guard(lock);
+    tasks_done.wait(guard, [this] { return pending == 0; });
+}
+
+void thread_pool_t::submit(task_t task) {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        tasks.push_back(std::move(task));
+        pending += 1;
+    }
+
+    task_ready.notify_one();
+}
+
+/*! \brief run 'body' for every index in [0, count) and wait for all of them.
+ *
+ * Indices are handed out dynamically, so uneven work balances across the
+ * workers.  The order in which indices run is unspecified.
+ */
+void thread_pool_t::parallel_for(size_t count,
+        std::function<void(size_t)> body) {
+    std::atomic<size_t> next(0);
+
+    for (uint32_t idx = 0; idx < size(); idx++) {
+        submit([&next, &body, count] {
+            for (size_t item = next++; item < count; item = next++) {
+                body(item);
+            }
+        });
+    }
+
+    wait();
+}
+
+/*! \brief number of hardware threads, or 1 if that is unknown.
+ */
+uint32_t thread_pool_t::default_size() {
+    uint32_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
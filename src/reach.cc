@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cassert>
+
+#include "reach.h"
+#include "snapshot.h"
+
+reach_index_t::reach_index_t() {
+    component_count = 0;
+    words = 0;
+}
+
+void reach_index_t::add_port(module_t* module_ds, symbol_t id) {
+    item_t item(module_ds, id);
+
+    if (port_index.emplace(item, ports.size()).second) {
+        ports.push_back(item);
+    }
+}
+
+/*! \brief contract the paths between ports into port-to-port edges.
+ *
+ * Each port node is searched from, without passing through other ports.  A
+ * path that crosses a timing edge continues in the timing layer, and module
+ * instances are crossed through all of their connections.
+ */
+void reach_index_t::build_port_graph(flow_graph_t& graph, thread_pool_t* pool,
+        adj_list_t& port_edges) {
+    index_list_t port_of(graph.size(), util_t::k_no_index);
+    index_list_t node_of(ports.size());
+
+    for (uint32_t idx = 0; idx < ports.size(); idx++) {
+        uint32_t node = graph.node(ports[idx].first, ports[idx].second);
+
+        port_of[node] = idx;
+        node_of[idx] = node;
+    }
+
+    uint32_t port_node_count = 2 * ports.size();
+    port_edges.assign(port_node_count, index_list_t());
+
+    auto search = [&](size_t worker, size_t worker_count) {
+        index_list_t seen(2 * graph.size(), util_t::k_no_index);
+        index_list_t found(port_node_count, util_t::k_no_index);
+        index_list_t stack;
+
+        uint32_t source = 0;
+
+        auto visit = [&](uint32_t target, uint32_t layer) {
+            if (port_of[target] != util_t::k_no_index) {
+                uint32_t port_node = 2 * port_of[target] + layer;
+
+                if (found[port_node] != source) {
+                    found[port_node] = source;
+                    port_edges[source].push_back(port_node);
+                }
+            } else if (seen[2 * target + layer] != source) {
+                seen[2 * target + layer] = source;
+                stack.push_back(2 * target + layer);
+            }
+        };
+
+        for (source = worker; source < port_node_count;
+                source += worker_count) {
+            stack.clear();
+            stack.push_back(2 * node_of[source >> 1] + (source & 1));
+            seen[stack.back()] = source;
+
+            while (stack.size() > 0) {
+                uint32_t state = stack.back();
+                stack.pop_back();
+
+                uint32_t node = state >> 1;
+                uint32_t layer = state & 1;
+
+                for (uint32_t edge : graph.successors(node)) {
+                    bool timing = (edge & 3) == flow_graph_t::EDGE_TIMING;
+                    visit(edge >> 3, timing ? 1 : layer);
+                }
+
+                for (uint32_t instance_idx : graph.instances(node)) {
+                    flow_graph_t::instance_t& instance =
+                        graph.instance(instance_idx);
+                    uint32_t last = instance.first_connection +
+                        instance.connection_count;
+
+                    for (uint32_t conn_idx = instance.first_connection;
+                            conn_idx < last; conn_idx++) {
+                        visit(graph.connection(conn_idx).port, layer);
+                    }
+                }
+            }
+        }
+    };
+
+    if (pool == nullptr) {
+        search(0, 1);
+        return;
+    }
+
+    size_t worker_count = pool->size();
+
+    pool->parallel_for(worker_count, [&search, worker_count](size_t worker) {
+        search(worker, worker_count);
+    });
+}
+
+/*! \brief number the strongly connected components of the port graph.
+ *
+ * Tarjan's algorithm emits the components successors first, so every
+ * component is numbered after the components it reaches.
+ */
+void reach_index_t::build_components(csr_t& graph) {
+    uint32_t node_count = graph.size();
+
+    index_list_t index(node_count, util_t::k_no_index), low(node_count);
+    std::vector<bool> on_stack(node_count, false);
+    index_list_t stack;
+    std::vector<std::pair<uint32_t, uint32_t> > dfs;
+
+    uint32_t counter = 0;
+
+    components.assign(node_count, util_t::k_no_index);
+    component_count = 0;
+
+    for (uint32_t root = 0; root < node_count; root++) {
+        if (index[root] != util_t::k_no_index) {
+            continue;
+        }
+
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = true;
+        dfs.push_back(std::make_pair(root, 0));
+
+        while (dfs.size() > 0) {
+            uint32_t node = dfs.back().first;
+            csr_t::range_t succs = graph[node];
+
+            if (dfs.back().second < succs.size()) {
+                uint32_t succ = succs.begin()[dfs.back().second++];
+
+                if (index[succ] == util_t::k_no_index) {
+                    index[succ] = low[succ] = counter++;
+                    stack.push_back(succ);
+                    on_stack[succ] = true;
+                    dfs.push_back(std::make_pair(succ, 0));
+                } else if (on_stack[succ]) {
+                    low[node] = std::min(low[node], index[succ]);
+                }
+
+                continue;
+            }
+
+            dfs.pop_back();
+
+            if (dfs.size() > 0) {
+                uint32_t parent = dfs.back().first;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+
+            if (low[node] != index[node]) {
+                continue;
+            }
+
+            uint32_t member = 0;
+
+            do {
+                member = stack.back();
+                stack.pop_back();
+
+                on_stack[member] = false;
+                components[member] = component_count;
+            } while (member != node);
+
+            component_count += 1;
+        }
+    }
+
+    build_members();
+}
+
+void reach_index_t::build_members() {
+    adj_list_t lists(component_count);
+
+    for (uint32_t node = 0; node < components.size(); node++) {
+        lists[components[node]].push_back(node);
+    }
+
+    members.build(lists);
+}
+
+/*! \brief compute the components reached from every component, in the
+ * order in which they were numbered.
+ *
+ * A component reaches itself only if it lies on a cycle.
+ */
+void reach_index_t::build_closure(csr_t& graph) {
+    words = (component_count + 63) / 64;
+    closure.assign((size_t) component_count * words, 0);
+
+    index_list_t merged(component_count, util_t::k_no_index);
+
+    for (uint32_t component = 0; component < component_count; component++) {
+        uint64_t* row = &closure[(size_t) component * words];
+
+        for (uint32_t node : members[component]) {
+            for (uint32_t succ : graph[node]) {
+                uint32_t target = components[succ];
+                row[target / 64] |= (uint64_t) 1 << (target % 64);
+
+                if (target == component || merged[target] == component) {
+                    continue;
+                }
+
+                merged[target] = component;
+
+                uint64_t* target_row = &closure[(size_t) target * words];
+
+                for (uint32_t word = 0; word < words; word++) {
+                    row[word] |= target_row[word];
+                }
+            }
+        }
+    }
+}
+
+/*! \brief build the index of all ports of a flow graph.
+ *
+ * The searches between ports run on 'pool', if any.
+ */
+void reach_index_t::build(flow_graph_t& graph, thread_pool_t* pool) {
+    ports.clear();
+    port_index.clear();
+
+    util_t::update_status("building reachability index ... ");
+
+    for (uint32_t node = 0; node < graph.size(); node++) {
+        if (graph.qualified_port(node) != util_t::k_no_index) {
+            add_port(graph.module_of(node), graph.id_of(node));
+        }
+    }
+
+    adj_list_t port_edges;
+    build_port_graph(graph, pool, port_edges);
+
+    csr_t port_graph;
+    port_graph.build(port_edges);
+    adj_list_t().swap(port_edges);
+
+    build_components(port_graph);
+    build_closure(port_graph);
+
+    util_t::clear_status();
+}
+
+bool reach_index_t::reached(uint32_t source, uint32_t target) {
+    return (closure[(size_t) source * words + target / 64] >>
+            (target % 64)) & 1;
+}
+
+/*! \brief check whether the index answers queries on a port.
+ */
+bool reach_index_t::contains(module_t* module_ds, symbol_t id) {
+    return port_index.find(item_t(module_ds, id)) != port_index.end();
+}
+
+/*! \brief types with which port 'target' may leak into port 'source', as
+ * DEP_TIMING and DEP_ORDINARY bits (zero if it does not leak).
+ *
+ * Both ports must be in the index (see contains()).
+ */
+state_t reach_index_t::leaks(module_t* source_ds, symbol_t source,
+        module_t* target_ds, symbol_t target) {
+    item_map_t::iterator source_it = port_index.find(item_t(source_ds, source));
+    item_map_t::iterator target_it = port_index.find(item_t(target_ds, target));
+
+    assert(source_it != port_index.end() && target_it != port_index.end() &&
+            "port is not in the reachability index!");
+
+    uint32_t source_port = source_it->second;
+    uint32_t target_port = target_it->second;
+
+    uint32_t component = components[2 * source_port];
+    state_t result = 0;
+
+    // Like a query, a port is not an ordinary leak of itself.
+    if (target_port != source_port &&
+            reached(component, components[2 * target_port])) {
+        result |= DEP_ORDINARY;
+    }
+
+    if (reached(component, components[2 * target_port + 1])) {
+        result |= DEP_TIMING;
+    }
+
+    return result;
+}
+
+/*! \brief ports that may leak into a port, by type.
+ *
+ * Returns false if the port is not in the index.
+ */
+bool reach_index_t::trace(module_t* module_ds, symbol_t id,
+        id_set_t& timing_deps, id_set_t& non_timing_deps) {
+    item_map_t::iterator it = port_index.find(item_t(module_ds, id));
+
+    if (it == port_index.end()) {
+        return false;
+    }
+
+    uint32_t source = 2 * it->second;
+    uint64_t* row = &closure[(size_t) components[source] * words];
+
+    for (uint32_t word = 0; word < words; word++) {
+        for (uint64_t bits = row[word]; bits != 0; bits &= bits - 1) {
+            uint32_t component = word * 64 + __builtin_ctzll(bits);
+
+            for (uint32_t node : members[component]) {
+                if (node == source) {
+                    continue;
+                }
+
+                item_t& port = ports[node >> 1];
+                symbol_t qualified = port.first->qualified_port(port.second);
+
+                if (node & 1) {
+                    timing_deps.insert(qualified);
+                } else {
+                    non_timing_deps.insert(qualified);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/*! \brief count of indexed ports.
+ */
+size_t reach_index_t::size() {
+    return ports.size();
+}
+
+/*! \brief approximate memory used by the closure and the components.
+ */
+size_t reach_index_t::bytes() {
+    return closure.size() * sizeof(uint64_t) +
+        2 * components.size() * sizeof(uint32_t) +
+        ports.size() * (sizeof(item_t) + 32);
+}
+
+void reach_index_t::write_snapshot(snapshot_writer_t& writer) {
+    writer.put_u32(ports.size());
+
+    for (item_t& port : ports) {
+        writer.put_string(port.first->name());
+        writer.put_u32(port.second);
+    }
+
+    writer.put_u32(component_count);
+    writer.put_indices(components);
+    writer.put_u32(words);
+
+    for (uint64_t word : closure) {
+        writer.put_u32((uint32_t) word);
+        writer.put_u32((uint32_t) (word >> 32));
+    }
+}
+
+/*! \brief restore an index written by write_snapshot().
+ *
+ * Returns false if the index is malformed or refers to missing modules.
+ */
+bool reach_index_t::read_snapshot(snapshot_reader_t& reader,
+        module_map_t& module_map) {
+    uint32_t port_count = reader.get_u32();
+
+    ports.clear();
+    port_index.clear();
+
+    for (uint32_t idx = 0; idx < port_count && reader.ok(); idx++) {
+        module_map_t::iterator it = module_map.find(reader.get_string());
+        symbol_t id = reader.get_symbol();
+
+        if (it == module_map.end()) {
+            reader.invalidate();
+            break;
+        }
+
+        add_port(it->second, id);
+    }
+
+    component_count = reader.get_u32();
+    reader.get_indices(components, component_count);
+    words = reader.get_u32();
+
+    if (reader.ok() == false || ports.size() != port_count ||
+            components.size() != 2 * (size_t) port_count ||
+            words != (component_count + 63) / 64) {
+        reader.invalidate();
+        return false;
+    }
+
+    // get_indices() lets util_t::k_no_index through, but every port has a
+    // component.
+    for (uint32_t component : components) {
+        if (component >= component_count) {
+            reader.invalidate();
+            return false;
+        }
+    }
+
+    closure.assign((size_t) component_count * words, 0);
+
+    for (size_t idx = 0; idx < closure.size() && reader.ok(); idx++) {
+        uint64_t low = reader.get_u32();
+        uint64_t high = reader.get_u32();
+
+        closure[idx] = low | high << 32;
+    }
+
+    if (reader.ok() == false) {
+        return false;
+    }
+
+    build_members();
+    return true;
+}
@@ -0,0 +1,358 @@
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#include "snapshot.h"
+
+void snapshot_writer_t::put_u8(uint8_t value) {
+    buffer.push_back((char) value);
+}
+
+void snapshot_writer_t::put_u32(uint32_t value) {
+    buffer.append((const char*) &value, sizeof(value));
+}
+
+void snapshot_writer_t::put_string(const identifier_t& value) {
+    put_u32(value.size());
+    buffer.append(value);
+}
+
+void snapshot_writer_t::put_ids(id_set_t& ids) {
+    put_u32(ids.size());
+
+    for (symbol_t id : ids) {
+        put_u32(id);
+    }
+}
+
+void snapshot_writer_t::put_ids(id_list_t& ids) {
+    put_u32(ids.size());
+
+    for (symbol_t id : ids) {
+        put_u32(id);
+    }
+}
+
+void snapshot_writer_t::put_indices(index_list_t& indices) {
+    put_u32(indices.size());
+
+    for (uint32_t index : indices) {
+        put_u32(index);
+    }
+}
+
+std::string& snapshot_writer_t::data() {
+    return buffer;
+}
+
+snapshot_reader_t::snapshot_reader_t(const char* data, size_t size) {
+    cursor = data;
+    limit = data + size;
+    failed = false;
+}
+
+bool snapshot_reader_t::reserve(size_t size) {
+    if (failed || (size_t) (limit - cursor) < size) {
+        failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool snapshot_reader_t::ok() {
+    return failed == false;
+}
+
+/*! \brief mark the payload as malformed.
+ */
+void snapshot_reader_t::invalidate() {
+    failed = true;
+}
+
+/*! \brief intern the symbol table of the snapshot.
+ */
+void snapshot_reader_t::read_symbols() {
+    uint32_t count = get_u32();
+
+    symbols.clear();
+
+    for (uint32_t idx = 0; idx < count && failed == false; idx++) {
+        symbols.push_back(symtab_t::intern(get_string()));
+    }
+}
+
+uint8_t snapshot_reader_t::get_u8() {
+    if (reserve(1) == false) {
+        return 0;
+    }
+
+    return (uint8_t) *cursor++;
+}
+
+uint32_t snapshot_reader_t::get_u32() {
+    uint32_t value = 0;
+
+    if (reserve(sizeof(value)) == false) {
+        return 0;
+    }
+
+    memcpy(&value, cursor, sizeof(value));
+    cursor += sizeof(value);
+
+    return value;
+}
+
+/*! \brief index below 'count', or util_t::k_no_index.
+ */
+uint32_t snapshot_reader_t::get_index(uint32_t count) {
+    uint32_t index = get_u32();
+
+    if (index >= count && index != util_t::k_no_index) {
+        failed = true;
+        return util_t::k_no_index;
+    }
+
+    return index;
+}
+
+symbol_t snapshot_reader_t::get_symbol() {
+    uint32_t index = get_u32();
+
+    if (index >= symbols.size()) {
+        failed = true;
+        return 0;
+    }
+
+    return symbols[index];
+}
+
+identifier_t snapshot_reader_t::get_string() {
+    uint32_t size = get_u32();
+
+    if (reserve(size) == false) {
+        return identifier_t();
+    }
+
+    identifier_t value(cursor, size);
+    cursor += size;
+
+    return value;
+}
+
+void snapshot_reader_t::get_ids(id_set_t& ids) {
+    uint32_t count = get_u32();
+
+    for (uint32_t idx = 0; idx < count && failed == false; idx++) {
+        ids.insert(get_symbol());
+    }
+}
+
+void snapshot_reader_t::get_ids(id_list_t& ids) {
+    uint32_t count = get_u32();
+
+    ids.clear();
+
+    for (uint32_t idx = 0; idx < count && failed == false; idx++) {
+        ids.push_back(get_symbol());
+    }
+}
+
+/*! \brief list of indices, each below 'limit' or util_t::k_no_index.
+ */
+void snapshot_reader_t::get_indices(index_list_t& indices, uint32_t limit) {
+    uint32_t count = get_u32();
+
+    indices.clear();
+
+    if (reserve((size_t) count * sizeof(uint32_t)) == false) {
+        return;
+    }
+
+    for (uint32_t idx = 0; idx < count && failed == false; idx++) {
+        indices.push_back(get_index(limit));
+    }
+}
+
+const char snapshot_t::k_magic[8] = { 'H', 'A', 'L', 'C', 'Y', 'O', 'N', 0 };
+const uint32_t snapshot_t::k_version;
+
+/*! \brief write the linked IR of all modules, including their dominators,
+ * and the reachability index, if any.
+ */
+bool snapshot_t::save(const identifier_t& filename, module_map_t& module_map,
+        reach_index_t* index) {
+    snapshot_writer_t writer;
+
+    // Build the dominators first, so that they are part of the snapshot.
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        it->second->build_dominator_sets();
+    }
+
+    util_t::update_status("writing snapshot ... ");
+
+    uint32_t symbol_count = symtab_t::size();
+    writer.put_u32(symbol_count);
+
+    for (symbol_t symbol = 0; symbol < symbol_count; symbol++) {
+        writer.put_string(symtab_t::name(symbol));
+    }
+
+    writer.put_u32(module_map.size());
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        it->second->write_snapshot(writer);
+    }
+
+    writer.put_u8(index != nullptr);
+
+    if (index != nullptr) {
+        index->write_snapshot(writer);
+    }
+
+    std::string& payload = writer.data();
+
+    header_t header;
+    memcpy(header.magic, k_magic, sizeof(header.magic));
+    header.version = k_version;
+    header.payload_size = payload.size();
+    header.checksum = crc32(crc32(0L, Z_NULL, 0),
+            (const Bytef*) payload.data(), payload.size());
+
+    FILE* file = fopen(filename.c_str(), "wb");
+
+    if (file == nullptr) {
+        util_t::fatal("failed to open snapshot '" + filename + "' for "
+                "writing.\n");
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+
+    written = fclose(file) == 0 && written;
+    util_t::clear_status();
+
+    if (written == false) {
+        util_t::fatal("failed to write snapshot '" + filename + "'.\n");
+    }
+
+    return written;
+}
+
+/*! \brief restore all modules of a snapshot into an empty module map.
+ *
+ * The file is mapped into memory, checked against its header, and decoded in
+ * place.  Module instantiations are then resolved and the def-use chains
+ * rebuilt, as after parsing the sources.  'index' is set to the reachability
+ * index of the snapshot, or nullptr if it has none.
+ */
+bool snapshot_t::load(const identifier_t& filename, module_map_t& module_map,
+        reach_index_t*& index) {
+    index = nullptr;
+
+    int fd = open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        util_t::fatal("failed to open snapshot '" + filename + "'.\n");
+        return false;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) != 0 ||
+            (size_t) file_stat.st_size < sizeof(header_t)) {
+        close(fd);
+        util_t::fatal("truncated snapshot '" + filename + "'.\n");
+        return false;
+    }
+
+    size_t file_size = file_stat.st_size;
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        util_t::fatal("failed to map snapshot '" + filename + "'.\n");
+        return false;
+    }
+
+    const char* data = (const char*) mapping;
+
+    header_t header;
+    memcpy(&header, data, sizeof(header));
+
+    const char* payload = data + sizeof(header);
+    size_t payload_size = file_size - sizeof(header);
+
+    identifier_t error;
+
+    if (memcmp(header.magic, k_magic, sizeof(header.magic)) != 0) {
+        error = "not a snapshot";
+    } else if (header.version != k_version) {
+        error = "unsupported snapshot version";
+    } else if (header.payload_size != payload_size) {
+        error = "truncated snapshot";
+    } else if (crc32(crc32(0L, Z_NULL, 0), (const Bytef*) payload,
+                payload_size) != header.checksum) {
+        error = "corrupted snapshot";
+    }
+
+    if (error.size() > 0) {
+        munmap(mapping, file_size);
+        util_t::fatal(error + ": '" + filename + "'.\n");
+        return false;
+    }
+
+    util_t::update_status("reading snapshot ... ");
+
+    snapshot_reader_t reader(payload, payload_size);
+    reader.read_symbols();
+
+    uint32_t module_count = reader.get_u32();
+
+    for (uint32_t idx = 0; idx < module_count && reader.ok(); idx++) {
+        module_t* module_ds = new module_t(reader);
+
+        if (module_map.emplace(module_ds->name(), module_ds).second == false) {
+            delete module_ds;
+        }
+    }
+
+    if (reader.ok() && reader.get_u8() != 0) {
+        index = new reach_index_t();
+
+        if (index->read_snapshot(reader, module_map) == false) {
+            delete index;
+            index = nullptr;
+        }
+    }
+
+    munmap(mapping, file_size);
+
+    if (reader.ok() == false) {
+        delete index;
+        index = nullptr;
+
+        util_t::fatal("malformed snapshot '" + filename + "'.\n");
+        return false;
+    }
+
+    util_t::update_status("building def-use chains ... ");
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        it->second->resolve_links(module_map);
+    }
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        it->second->build_def_use_chains();
+    }
+
+    util_t::clear_status();
+    return true;
+}
@@ -0,0 +1,90 @@
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+#include <zlib.h>
+
+#include "sources.h"
+
+/*! \brief CRC-32 of the contents of a file.
+ */
+bool source_table_t::checksum(const identifier_t& filename, uint32_t& crc) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+
+    if (file.is_open() == false) {
+        return false;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    const std::string& data = contents.str();
+    crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef*) data.data(),
+            data.size());
+
+    return true;
+}
+
+/*! \brief start tracking a file (again), recording its current checksum.
+ */
+bool source_table_t::add_file(const identifier_t& filename) {
+    uint32_t crc = 0;
+
+    if (checksum(filename, crc) == false) {
+        util_t::warn("failed to read source file '" + filename + "'.\n");
+        return false;
+    }
+
+    sources[filename].checksum = crc;
+    return true;
+}
+
+/*! \brief record that 'filename' defines the module 'module_name'.
+ */
+void source_table_t::add_module(const identifier_t& filename,
+        const identifier_t& module_name) {
+    sources[filename].modules.push_back(module_name);
+}
+
+void source_table_t::clear_modules(const identifier_t& filename) {
+    sources[filename].modules.clear();
+}
+
+/*! \brief tracked files whose contents differ from the recorded checksum.
+ *
+ * Files that can no longer be read are skipped with a warning.
+ */
+void source_table_t::changed_files(name_list_t& filenames) {
+    for (auto it = sources.begin(); it != sources.end(); it++) {
+        uint32_t crc = 0;
+
+        if (checksum(it->first, crc) == false) {
+            util_t::warn("failed to read source file '" + it->first +
+                    "'.\n");
+            continue;
+        }
+
+        if (crc != it->second.checksum) {
+            filenames.push_back(it->first);
+        }
+    }
+}
+
+bool source_table_t::contains(const identifier_t& filename) {
+    return sources.find(filename) != sources.end();
+}
+
+/*! \brief names of the modules defined by a tracked file.
+ */
+name_list_t& source_table_t::modules(const identifier_t& filename) {
+    source_map_t::iterator it = sources.find(filename);
+    assert(it != sources.end() && "untracked source file!");
+
+    return it->second.modules;
+}
+
+/*! \brief number of tracked source files.
+ */
+size_t source_table_t::size() {
+    return sources.size();
+}
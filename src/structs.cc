@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <iterator>
 
 #include <VeriConstVal.h>
 #include <VeriExpression.h>
@@ -9,6 +10,7 @@
 #include <VeriModule.h>
 #include <veri_tokens.h>
 
+#include "snapshot.h"
 #include "structs.h"
 
 /*! \brief catch-all error routine
@@ -26,8 +28,9 @@ void balk(VeriTreeNode* tree_node, const std::string& msg, const char* filename,
     assert(false && "unrecoverable error!");
 }
 
-instr_t::instr_t(bb_t* parent) {
+instr_t::instr_t(bb_t* parent, state_t kind) {
     containing_bb = parent;
+    instr_kind = kind;
 }
 
 instr_t::~instr_t() {
@@ -132,7 +135,7 @@ void util_t::describe_expr(VeriExpression* expr, id_desc_list_t& desc_list,
         // arguments to the function are used.
 
         FOREACH_ARRAY_ITEM(function_call->GetArgs(), idx, id_ref) {
-            identifier_t id = id_ref->GetId()->Name();
+            symbol_t id = symtab_t::intern(id_ref->GetId()->Name());
 
             id_desc_t desc = { id, STATE_USE };
             desc_list.push_back(desc);
@@ -154,15 +157,17 @@ void util_t::describe_expr(VeriExpression* expr, id_desc_list_t& desc_list,
             describe_expr(expression, desc_list, type_hint, module);
         }
     } else if (auto id_ref = dynamic_cast<VeriIdRef*>(expr)) {
-        id_desc_t desc = { id_ref->GetName(), type_hint };
+        id_desc_t desc = { symtab_t::intern(id_ref->GetName()), type_hint };
         desc_list.push_back(desc);
     } else if (auto indexed_id = dynamic_cast<VeriIndexedId*>(expr)) {
-        id_desc_t desc = { indexed_id->GetName(), type_hint };
+        id_desc_t desc = { symtab_t::intern(indexed_id->GetName()),
+                type_hint };
         desc_list.push_back(desc);
 
         describe_expr(indexed_id->GetIndexExpr(), desc_list, STATE_USE, module);
     } else if (auto idx_mem_id = dynamic_cast<VeriIndexedMemoryId*>(expr)) {
-        id_desc_t desc = { idx_mem_id->GetName(), type_hint };
+        id_desc_t desc = { symtab_t::intern(idx_mem_id->GetName()),
+                type_hint };
         desc_list.push_back(desc);
 
         uint32_t idx = 0;
@@ -172,10 +177,12 @@ void util_t::describe_expr(VeriExpression* expr, id_desc_list_t& desc_list,
             describe_expr(expression, desc_list, STATE_USE, module);
         }
     } else if (auto selected_name = dynamic_cast<VeriSelectedName*>(expr)) {
-        id_desc_t desc = { selected_name->GetPrefix()->GetName(), type_hint };
+        const char* prefix = selected_name->GetPrefix()->GetName();
+
+        id_desc_t desc = { symtab_t::intern(prefix), type_hint };
         desc_list.push_back(desc);
 
-        desc = { selected_name->GetSuffix(), type_hint };
+        desc = { symtab_t::intern(selected_name->GetSuffix()), type_hint };
         desc_list.push_back(desc);
     } else if (auto new_expr = dynamic_cast<VeriNew*>(expr)) {
         describe_expr(new_expr->GetSizeExpr(), desc_list, type_hint, module);
@@ -193,7 +200,8 @@ void util_t::describe_expr(VeriExpression* expr, id_desc_list_t& desc_list,
         describe_expr(pattern_match->GetLeft(), desc_list, type_hint, module);
         describe_expr(pattern_match->GetRight(), desc_list, type_hint, module);
     } else if (auto port_conn = dynamic_cast<VeriPortConnect*>(expr)) {
-        id_desc_t desc = { port_conn->GetNamedFormal(), type_hint };
+        id_desc_t desc = { symtab_t::intern(port_conn->GetNamedFormal()),
+                type_hint };
         desc_list.push_back(desc);
 
         describe_expr(port_conn->GetConnection(), desc_list, type_hint, module);
@@ -237,7 +245,8 @@ void instr_t::parse_expression(VeriExpression* expr, uint8_t dst_set) {
         }
 
         if (desc.type == 0) {
-            util_t::fatal("invalid state type for '" + desc.name + "'");
+            util_t::fatal("invalid state type for '" +
+                    symtab_t::name(desc.name) + "'");
             assert(false && "invalid destination!");
         }
     }
@@ -284,7 +293,8 @@ void instr_t::parse_statement(VeriStatement* stmt) {
         parse_expression(wait->GetCondition(), STATE_USE);
         parse_statement(wait->GetStmt());
     } else if (auto seq_block = dynamic_cast<VeriSeqBlock*>(stmt)) {
-        pinstr_t* pinstr = new pinstr_t(this, stmt);
+        module_t* module_ds = this->parent()->parent();
+        pinstr_t* pinstr = module_ds->arena().make<pinstr_t>(this, stmt);
         pinstrs.push_back(pinstr);
     } else if (dynamic_cast<VeriConditionalStatement*>(stmt) != nullptr) {
         module_t* module_ds = this->parent()->parent();
@@ -292,7 +302,8 @@ void instr_t::parse_statement(VeriStatement* stmt) {
         // FIXME: Wrap this basic block and its successors into an instruction.
         bb_t* new_bb = module_ds->create_empty_bb("nested", BB_HIDDEN, true);
 
-        new_bb->append(new cmpr_t(new_bb, stmt->GetIfExpr()));
+        arena_t& arena = module_ds->arena();
+        new_bb->append(arena.make<cmpr_t>(new_bb, stmt->GetIfExpr()));
         bb_t* merge_bb = module_ds->create_empty_bb("merge", BB_ORDINARY, true);
 
         bb_t* then_bb = module_ds->create_empty_bb("then", BB_ORDINARY, true);
@@ -325,6 +336,15 @@ bb_t* instr_t::parent() {
     return containing_bb;
 }
 
+/*! \brief kind of this instruction (one of INSTR_*).
+ *
+ * The analysis dispatches on the kind instead of using dynamic_cast, which is
+ * too expensive for the query loop.
+ */
+state_t instr_t::kind() {
+    return instr_kind;
+}
+
 /*! \brief set of identifiers defined by this instruction.
  */
 id_set_t& instr_t::defs() {
@@ -337,15 +357,15 @@ id_set_t& instr_t::uses() {
     return use_set;
 }
 
-void instr_t::add_def(identifier_t def_id) {
+void instr_t::add_def(symbol_t def_id) {
     def_set.insert(def_id);
 }
 
-void instr_t::add_use(identifier_t use_id) {
+void instr_t::add_use(symbol_t use_id) {
     use_set.insert(use_id);
 }
 
-param_t::param_t(bb_t* parent, identifier_t name) : instr_t(parent)  {
+param_t::param_t(bb_t* parent, symbol_t name) : instr_t(parent, INSTR_PARAM)  {
     param_name = name;
     add_def(param_name);
 }
@@ -354,7 +374,8 @@ param_t::param_t(bb_t* parent, identifier_t name) : instr_t(parent)  {
  */
 void param_t::dump() {
     identifier_t module_name = parent()->parent()->name();
-    util_t::plain("param: " + param_name + " in module " + module_name + "\n");
+    util_t::plain("param: " + symtab_t::name(param_name) + " in module " +
+            module_name + "\n");
 }
 
 bool param_t::operator==(const instr_t& reference) {
@@ -365,7 +386,8 @@ bool param_t::operator==(const instr_t& reference) {
     return false;
 }
 
-trigger_t::trigger_t(bb_t* parent, id_set_t& trigger_ids) : instr_t(parent)  {
+trigger_t::trigger_t(bb_t* parent, id_set_t& trigger_ids)
+        : instr_t(parent, INSTR_TRIGGER) {
     id_set = trigger_ids;
     def_set.insert(id_set.begin(), id_set.end());
 }
@@ -375,8 +397,8 @@ trigger_t::trigger_t(bb_t* parent, id_set_t& trigger_ids) : instr_t(parent)  {
 void trigger_t::dump() {
     std::cerr << "trigger:";
 
-    for (identifier_t id : id_set) {
-        std::cerr << " " << id;
+    for (symbol_t id : id_set) {
+        std::cerr << " " << symtab_t::name(id);
     }
 
     std::cerr << " in module " << parent()->parent()->name() << "\n";
@@ -394,7 +416,8 @@ bool trigger_t::operator==(const instr_t& reference) {
     return false;
 }
 
-stmt_t::stmt_t(bb_t* parent, VeriStatement* __stmt) : instr_t(parent)  {
+stmt_t::stmt_t(bb_t* parent, VeriStatement* __stmt)
+        : instr_t(parent, INSTR_STMT)  {
     stmt = __stmt;
     parse_statement(stmt);
 }
@@ -419,7 +442,7 @@ bool stmt_t::operator==(const instr_t& reference) {
 }
 
 assign_t::assign_t(bb_t* parent, VeriNetRegAssign* __assign)
-        : instr_t(parent)  {
+        : instr_t(parent, INSTR_ASSIGN)  {
     assign = __assign;
     parse_expression(assign->GetLValExpr(), STATE_DEF);
     parse_expression(assign->GetRValExpr(), STATE_USE);
@@ -445,15 +468,30 @@ bool assign_t::operator==(const instr_t& reference) {
 }
 
 invoke_t::invoke_t(bb_t* parent, VeriInstId* __inst, identifier_t __name)
-        : instr_t(parent)  {
+        : instr_t(parent, INSTR_INVOKE)  {
     mod_inst = __inst;
     mod_name = __name;
 
     parse_invocation();
 }
 
+/*! \brief restore a module instantiation from its connections.
+ *
+ * Used when loading a snapshot, where the Verific instance is not available.
+ */
+invoke_t::invoke_t(bb_t* parent, identifier_t __name, conn_list_t& __conns)
+        : instr_t(parent, INSTR_INVOKE)  {
+    mod_inst = nullptr;
+    mod_name = __name;
+    conns = __conns;
+}
+
 bool invoke_t::operator==(const instr_t& reference) {
     if (const invoke_t* ref = dynamic_cast<const invoke_t*>(&reference)) {
+        if (mod_inst == nullptr) {
+            return this == ref;
+        }
+
         return mod_inst == ref->mod_inst;
     }
 
@@ -471,8 +509,10 @@ void invoke_t::parse_invocation() {
         util_t::describe_expr(connect->GetConnection(), desc_list, STATE_USE,
                 parent()->parent());
 
+        const char* formal = connect->GetNamedFormal();
+
         conn_t connection;
-        connection.remote_endpoint = connect->GetNamedFormal();
+        connection.remote_endpoint = symtab_t::intern(formal);
 
         for (id_desc_t desc : desc_list) {
             connection.id_set.insert(desc.name);
@@ -486,7 +526,11 @@ void invoke_t::parse_invocation() {
  */
 void invoke_t::dump() {
     std::cerr << "remote module: " << mod_name << ": ";
-    mod_inst->PrettyPrint(std::cerr, 100);
+
+    if (mod_inst != nullptr) {
+        mod_inst->PrettyPrint(std::cerr, 100);
+    }
+
     std::cerr << " in module " << parent()->parent()->name() << "\n";
 }
 
@@ -498,9 +542,14 @@ conn_list_t& invoke_t::connections() {
     return conns;
 }
 
-cmpr_t::cmpr_t(bb_t* parent, VeriExpression* __cmpr) : instr_t(parent) {
+cmpr_t::cmpr_t(bb_t* parent, VeriExpression* __cmpr)
+        : instr_t(parent, INSTR_CMPR) {
     cmpr = __cmpr;
-    parse_expression(cmpr, STATE_USE);
+
+    // Comparisons restored from a snapshot have no expression.
+    if (cmpr != nullptr) {
+        parse_expression(cmpr, STATE_USE);
+    }
 }
 
 VeriExpression* cmpr_t::comparison() {
@@ -510,7 +559,16 @@ VeriExpression* cmpr_t::comparison() {
 /*! \brief print instruction to the console (stderr).
  */
 void cmpr_t::dump() {
-    cmpr->PrettyPrint(std::cerr, 100);
+    if (cmpr == nullptr) {
+        std::cerr << "comparison:";
+
+        for (symbol_t id : use_set) {
+            std::cerr << " " << symtab_t::name(id);
+        }
+    } else {
+        cmpr->PrettyPrint(std::cerr, 100);
+    }
+
     std::cerr << " in module " << parent()->parent()->name() << "\n";
 }
 
@@ -522,10 +580,11 @@ bool cmpr_t::operator==(const instr_t& reference) {
     return false;
 }
 
-data_decl_t::data_decl_t(bb_t* parent, VeriIdDef* __decl) : instr_t(parent) {
+data_decl_t::data_decl_t(bb_t* parent, VeriIdDef* __decl)
+        : instr_t(parent, INSTR_DATA_DECL) {
     decl = __decl;
 
-    def_set.insert(decl->GetName());
+    def_set.insert(symtab_t::intern(decl->GetName()));
 
     VeriExpression* init_val = decl->GetInitialValue();
 
@@ -549,6 +608,32 @@ bool data_decl_t::operator==(const instr_t& reference) {
     return false;
 }
 
+snapshot_instr_t::snapshot_instr_t(bb_t* parent, state_t kind)
+        : instr_t(parent, kind) {
+}
+
+/*! \brief print instruction to the console (stderr).
+ */
+void snapshot_instr_t::dump() {
+    std::cerr << "instruction (kind " << (uint32_t) kind() << "): defs";
+
+    for (symbol_t id : def_set) {
+        std::cerr << " " << symtab_t::name(id);
+    }
+
+    std::cerr << ", uses";
+
+    for (symbol_t id : use_set) {
+        std::cerr << " " << symtab_t::name(id);
+    }
+
+    std::cerr << " in module " << parent()->parent()->name() << "\n";
+}
+
+bool snapshot_instr_t::operator==(const instr_t& reference) {
+    return this == &reference;
+}
+
 pinstr_t::pinstr_t(instr_t* parent, VeriStatement* __stmt) {
     stmt = __stmt;
     containing_instr = parent;
@@ -564,11 +649,11 @@ pinstr_t::pinstr_t(instr_t* parent, VeriStatement* __stmt) {
 
     for (bb_t* bb : reachable_bbs) {
         for (instr_t* instr : bb->instrs()) {
-            for (identifier_t def_id : instr->defs()) {
+            for (symbol_t def_id : instr->defs()) {
                 parent->add_def(def_id);
             }
 
-            for (identifier_t use_id : instr->uses()) {
+            for (symbol_t use_id : instr->uses()) {
                 parent->add_use(use_id);
             }
         }
@@ -585,8 +670,10 @@ void pinstr_t::dump() {
     std::cerr << " in module " << module_ds->name() << "\n";
 }
 
-bb_t::bb_t(module_t* parent, const identifier_t& __name, state_t __bb_type) {
+bb_t::bb_t(module_t* parent, const identifier_t& __name, state_t __bb_type,
+        uint32_t __index) {
     bb_name = __name;
+    bb_index = __index;
     entry_bb = nullptr;
     bb_type = __bb_type;
     containing_module = parent;
@@ -599,11 +686,7 @@ bb_t::~bb_t() {
     successor_left = nullptr;
     successor_right = nullptr;
 
-    for (instr_t* instr : instr_list) {
-        delete instr;
-        instr = nullptr;
-    }
-
+    // Instructions are owned by the module's arena.
     instr_list.clear();
     predecessors.clear();
 }
@@ -792,13 +875,21 @@ cmpr_t* bb_t::comparison() {
     }
 
     instr_t* last_instr = instr_list.back();
-    cmpr_t* comparison = dynamic_cast<cmpr_t*>(last_instr);
 
-    if (comparison == nullptr) {
+    if (last_instr->kind() != INSTR_CMPR) {
         return nullptr;
     }
 
-    return comparison;
+    return static_cast<cmpr_t*>(last_instr);
+}
+
+/*! \brief dense index of this basic block within the containing module.
+ *
+ * Every block (including BB_HIDDEN blocks) gets an index, so that per-block
+ * data in module_t can be kept in flat arrays.
+ */
+uint32_t bb_t::index() {
+    return bb_index;
 }
 
 /*! \brief pointer to the module that contains this basic block.
@@ -816,15 +907,246 @@ module_t::module_t(VeriModule*& module) {
     process_module_items(module->GetModuleItems());
     process_module_params(module->GetParameters());
     process_module_ports(module->GetPortConnects());
+
+    freeze_cfg();
 }
 
-module_t::~module_t() {
-    for (bb_t* bb : basicblocks) {
-        delete bb;
-        bb = nullptr;
+/*! \brief restore a module written by write_snapshot().
+ *
+ * Blocks, instructions and dominator data are restored as they were saved.
+ * Module instantiations are not resolved here (see resolve_links()).
+ */
+module_t::module_t(snapshot_reader_t& reader) {
+    empty_dominators = true;
+    mod_name = reader.get_string();
+    primitive = reader.get_u8() != 0;
+
+    uint32_t arg_count = reader.get_u32();
+
+    for (uint32_t idx = 0; idx < arg_count && reader.ok(); idx++) {
+        symbol_t id = reader.get_symbol();
+        state_t state = reader.get_u8();
+
+        if (reader.get_u8() != 0) {
+            add_port(id, state);
+        } else {
+            add_arg(id, state);
+        }
+    }
+
+    uint32_t count = reader.get_u32();
+    index_list_t lefts, rights;
+
+    for (uint32_t idx = 0; idx < count && reader.ok(); idx++) {
+        identifier_t bb_name = reader.get_string();
+        state_t bb_type = reader.get_u8();
+        bool floating = reader.get_u8() != 0;
+
+        // Names are already unique, so bypass create_empty_bb().
+        bb_t* bb = ir_arena.make<bb_t>(this, bb_name, bb_type, idx);
+        bb_table.push_back(bb);
+        top_level_blocks.insert(bb);
+
+        if (floating == false) {
+            basicblocks.push_back(bb);
+        }
+
+        lefts.push_back(reader.get_index(count));
+        rights.push_back(reader.get_index(count));
+    }
+
+    for (uint32_t idx = 0; idx < bb_table.size() && reader.ok(); idx++) {
+        if (lefts[idx] != util_t::k_no_index) {
+            bb_table[idx]->set_left_successor(bb_table[lefts[idx]]);
+        }
+
+        if (rights[idx] != util_t::k_no_index) {
+            bb_table[idx]->set_right_successor(bb_table[rights[idx]]);
+        }
+    }
+
+    for (uint32_t idx = 0; idx < bb_table.size() && reader.ok(); idx++) {
+        bb_t* bb = bb_table[idx];
+        uint32_t instr_count = reader.get_u32();
+
+        for (uint32_t instr_idx = 0; instr_idx < instr_count && reader.ok();
+                instr_idx++) {
+            state_t kind = reader.get_u8();
+            instr_t* instr = nullptr;
+
+            if (kind == INSTR_TRIGGER) {
+                id_set_t ids;
+                reader.get_ids(ids);
+
+                instr = ir_arena.make<trigger_t>(bb, ids);
+            } else if (kind == INSTR_INVOKE) {
+                identifier_t module_name = reader.get_string();
+                uint32_t conn_count = reader.get_u32();
+                conn_list_t conns;
+
+                for (uint32_t conn_idx = 0; conn_idx < conn_count &&
+                        reader.ok(); conn_idx++) {
+                    conn_t connection;
+                    connection.state = reader.get_u8();
+                    connection.remote_endpoint = reader.get_symbol();
+                    reader.get_ids(connection.id_set);
+
+                    conns.push_back(connection);
+                }
+
+                invoke_t* invoke = ir_arena.make<invoke_t>(bb, module_name,
+                        conns);
+                invoke_list.push_back(invoke);
+
+                instr = invoke;
+            } else if (kind == INSTR_CMPR) {
+                instr = ir_arena.make<cmpr_t>(bb, nullptr);
+            } else {
+                instr = ir_arena.make<snapshot_instr_t>(bb, kind);
+            }
+
+            id_set_t defs, uses;
+            reader.get_ids(defs);
+            reader.get_ids(uses);
+
+            for (symbol_t id : defs) {
+                instr->add_def(id);
+            }
+
+            for (symbol_t id : uses) {
+                instr->add_use(id);
+            }
+
+            bb->append(instr);
+        }
+    }
+
+    freeze_cfg();
+
+    // Pre- and post-order numbers share one clock, so they run up to twice
+    // the number of blocks.
+    reader.get_indices(imm_dominator, count);
+    reader.get_indices(imm_postdominator, count);
+    reader.get_indices(pdom_pre, 2 * count);
+    reader.get_indices(pdom_post, 2 * count);
+    reader.get_indices(imm_guard, count);
+
+    implicit_ids.assign(count, id_list_t());
+    trigger_ids.assign(count, id_list_t());
+
+    for (uint32_t idx = 0; idx < count && reader.ok(); idx++) {
+        reader.get_ids(implicit_ids[idx]);
+        reader.get_ids(trigger_ids[idx]);
+    }
+
+    if (imm_dominator.size() != count || imm_postdominator.size() != count ||
+            pdom_pre.size() != count || pdom_post.size() != count ||
+            imm_guard.size() != count) {
+        reader.invalidate();
     }
 
+    if (reader.ok()) {
+        invert_block_summaries();
+    }
+
+    empty_dominators = reader.ok() == false;
+}
+
+/*! \brief write this module, including its dominators, to a snapshot.
+ *
+ * See module_t(snapshot_reader_t&) for the inverse operation.
+ */
+void module_t::write_snapshot(snapshot_writer_t& writer) {
+    build_dominator_sets();
+
+    writer.put_string(mod_name);
+    writer.put_u8(primitive);
+
+    std::map<symbol_t, state_t> sorted_args(arg_states.begin(),
+            arg_states.end());
+    writer.put_u32(sorted_args.size());
+
+    for (auto it = sorted_args.begin(); it != sorted_args.end(); it++) {
+        writer.put_u32(it->first);
+        writer.put_u8(it->second);
+        writer.put_u8(port_exists(it->first));
+    }
+
+    bb_set_t listed(basicblocks.begin(), basicblocks.end());
+    writer.put_u32(bb_table.size());
+
+    for (bb_t* bb : bb_table) {
+        bb_t* left = bb->left_successor();
+        bb_t* right = bb->right_successor();
+
+        writer.put_string(bb->name());
+        writer.put_u8(bb->block_type());
+        writer.put_u8(listed.find(bb) == listed.end());
+        writer.put_u32(left != nullptr ? left->index() : util_t::k_no_index);
+        writer.put_u32(right != nullptr ? right->index() : util_t::k_no_index);
+    }
+
+    for (bb_t* bb : bb_table) {
+        writer.put_u32(bb->instrs().size());
+
+        for (instr_t* instr : bb->instrs()) {
+            writer.put_u8(instr->kind());
+
+            if (instr->kind() == INSTR_TRIGGER) {
+                writer.put_ids(static_cast<trigger_t*>(instr)->trigger_ids());
+            } else if (instr->kind() == INSTR_INVOKE) {
+                invoke_t* invoke = static_cast<invoke_t*>(instr);
+                writer.put_string(invoke->module_name());
+                writer.put_u32(invoke->connections().size());
+
+                for (conn_t& connection : invoke->connections()) {
+                    writer.put_u8(connection.state);
+                    writer.put_u32(connection.remote_endpoint);
+                    writer.put_ids(connection.id_set);
+                }
+            }
+
+            writer.put_ids(instr->defs());
+            writer.put_ids(instr->uses());
+        }
+    }
+
+    writer.put_indices(imm_dominator);
+    writer.put_indices(imm_postdominator);
+    writer.put_indices(pdom_pre);
+    writer.put_indices(pdom_post);
+    writer.put_indices(imm_guard);
+
+    for (uint32_t idx = 0; idx < bb_table.size(); idx++) {
+        writer.put_ids(implicit_ids[idx]);
+        writer.put_ids(trigger_ids[idx]);
+    }
+}
+
+module_t::~module_t() {
+    // Blocks and instructions are released along with 'ir_arena'.
     basicblocks.clear();
+    bb_table.clear();
+}
+
+/*! \brief arena that owns the basic blocks and instructions of this module.
+ */
+arena_t& module_t::arena() {
+    return ir_arena;
+}
+
+/*! \brief frozen control-flow graph of this module.
+ */
+cfg_t& module_t::cfg() {
+    return flow_graph;
+}
+
+/*! \brief build the frozen CFG once all basic blocks exist.
+ *
+ * This also assigns the entry block of every basic block.
+ */
+void module_t::freeze_cfg() {
+    flow_graph.build(bb_table);
 }
 
 /*! \brief name of this module.
@@ -836,7 +1158,9 @@ identifier_t module_t::name() {
 bb_t* module_t::create_empty_bb(identifier_t name, state_t bb_type,
         bool floating) {
     identifier_t bb_name = make_unique_bb_id(name);
-    bb_t* new_block = new bb_t(this, bb_name, bb_type);
+    uint32_t bb_index = bb_table.size();
+    bb_t* new_block = ir_arena.make<bb_t>(this, bb_name, bb_type, bb_index);
+    bb_table.push_back(new_block);
 
     if (floating == false) {
         basicblocks.push_back(new_block);
@@ -879,7 +1203,8 @@ void module_t::intersect(bb_set_t& dst_set, bb_set_t& src_set) {
     dst_set.erase(dst_it, dst_set.end());
 }
 
-bool module_t::update_dominators(bb_t* focus_bb, bb_set_t& reachable) {
+bool module_t::update_dominators(bb_t* focus_bb, bb_set_t& reachable,
+        bb_set_map_t& dominators) {
     bb_set_t new_dominators;
 
     // initialize to all basic blocks to prepare for subsequent intersection.
@@ -902,7 +1227,8 @@ bool module_t::update_dominators(bb_t* focus_bb, bb_set_t& reachable) {
     return false;
 }
 
-bool module_t::update_postdominators(bb_t* focus_bb, bb_set_t& reachable) {
+bool module_t::update_postdominators(bb_t* focus_bb, bb_set_t& reachable,
+        bb_set_map_t& postdominators) {
     bb_set_t new_postdominators;
 
     // initialize to all basic blocks to prepare for subsequent intersection.
@@ -931,7 +1257,8 @@ bool module_t::update_postdominators(bb_t* focus_bb, bb_set_t& reachable) {
     return false;
 }
 
-bb_t* module_t::find_imm_dominator(bb_t* start_bb, bb_set_t& dom_set) {
+bb_t* module_t::find_imm_dominator(bb_t* start_bb, bb_set_t& dom_set,
+        bb_set_map_t& dominators) {
     bb_t* imm_dominator = nullptr;
     dom_set.erase(start_bb);
 
@@ -967,7 +1294,7 @@ bb_t* module_t::find_imm_dominator(bb_t* start_bb, bb_set_t& dom_set) {
 }
 
 bb_t* module_t::find_imm_postdominator(bb_t* start_bb,
-        bb_set_t& pdom_set) {
+        bb_set_t& pdom_set, bb_set_map_t& postdominators) {
     bb_t* imm_postdominator = nullptr;
     pdom_set.erase(start_bb);
 
@@ -1001,8 +1328,15 @@ bb_t* module_t::find_imm_postdominator(bb_t* start_bb,
     return imm_postdominator;
 }
 
-void module_t::build_dominator_sets(bb_set_t& reachable) {
+/*! \brief find dominators using the iterative (fixpoint) algorithm.
+ *
+ * This is the original O(V^2) implementation.  It is no longer used for
+ * analysis, but it is retained as the reference for check_dominator_sets().
+ */
+void module_t::build_dominator_sets(bb_set_t& reachable, bb_map_t& imm_dom_map,
+        bb_map_t& imm_pdom_map) {
     bb_set_t empty_set;
+    bb_set_map_t dominators, postdominators;
 
     // initialize dominator objects for blocks in the reachable set.
     for (bb_t* bb : reachable) {
@@ -1028,11 +1362,13 @@ void module_t::build_dominator_sets(bb_set_t& reachable) {
         change = false;
 
         for (bb_t* bb : reachable) {
-            if (bb->pred_count() > 0 && update_dominators(bb, reachable)) {
+            if (bb->pred_count() > 0 &&
+                    update_dominators(bb, reachable, dominators)) {
                 change = true;
             }
 
-            if (bb->succ_count() > 0 && update_postdominators(bb, reachable)) {
+            if (bb->succ_count() > 0 &&
+                    update_postdominators(bb, reachable, postdominators)) {
                 change = true;
             }
         }
@@ -1040,176 +1376,549 @@ void module_t::build_dominator_sets(bb_set_t& reachable) {
 
     for (bb_t* bb : reachable) {
         bb_set_t& dom_set = dominators[bb];
-        imm_dominator[bb] = find_imm_dominator(bb, dom_set);
+        imm_dom_map[bb] = find_imm_dominator(bb, dom_set, dominators);
 
         bb_set_t& pdom_set = postdominators[bb];
-        imm_postdominator[bb] = find_imm_postdominator(bb, pdom_set);
+        imm_pdom_map[bb] = find_imm_postdominator(bb, pdom_set,
+                postdominators);
     }
 }
 
-/*! \brief find the dominator and postdominators of each basic block.
- *
- * For simplicity, we use the O(V^2) iterative algorithm.  The Lengauer-Tarjan
- * Dominator Tree Algorithm will almost surely improve analysis performance.
+/*! \brief number the postdominator forest with DFS pre/post intervals.
  */
-void module_t::build_dominator_sets() {
-    if (empty_dominators == false) {
-        return;
+void module_t::number_postdominator_tree() {
+    uint32_t count = bb_table.size();
+    adj_list_t children(count);
+    index_list_t forest_roots;
+
+    for (uint32_t idx = 0; idx < count; idx++) {
+        if (imm_postdominator[idx] == util_t::k_no_index) {
+            forest_roots.push_back(idx);
+        } else {
+            children[imm_postdominator[idx]].push_back(idx);
+        }
     }
 
-    char message[128];
-    snprintf(message, sizeof(message), "building dominators for module %s... ",
-            name().substr(0, 8).c_str());
-    util_t::update_status(message);
+    pdom_pre.assign(count, util_t::k_no_index);
+    pdom_post.assign(count, util_t::k_no_index);
 
-    for (bb_t* bb : top_level_blocks) {
-        assert(bb->pred_count() == 0 && "not a top-level block!");
+    uint32_t clock = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
 
-        bb_set_t reachable;
-        util_t::build_reachable_set(bb, reachable);
-        build_dominator_sets(reachable);
-    }
+    for (uint32_t root : forest_roots) {
+        pdom_pre[root] = clock++;
+        stack.emplace_back(root, 0);
 
-    empty_dominators = false;
-}
+        while (stack.size() > 0) {
+            uint32_t node = stack.back().first;
+            uint32_t next = stack.back().second;
 
-/*! \brief find the definitions and uses of each instruction in this module.
- */
-void module_t::build_def_use_chains() {
-    for (bb_t* bb : basicblocks) {
-        for (instr_t* instr : bb->instrs()) {
-            for (identifier_t id : instr->defs()) {
-                add_def(id, instr);
+            if (next == children[node].size()) {
+                pdom_post[node] = clock++;
+                stack.pop_back();
+                continue;
             }
 
-            for (identifier_t id : instr->uses()) {
-                add_use(id, instr);
-            }
+            stack.back().second += 1;
+            uint32_t child = children[node][next];
+
+            pdom_pre[child] = clock++;
+            stack.emplace_back(child, 0);
         }
     }
 }
 
-bool module_t::process_connection(conn_t& connection, invoke_t* invocation,
-        module_t* invoked_module) {
-    if (connection.state == STATE_UNKNOWN) {
-        return false;
-    }
+/*! \brief precompute the query-independent dependences of each block.
+ *
+ * For every block, this computes (1) the "implicit-flow" identifiers, i.e.
+ * the union of the uses of the comparisons that guard the block, and (2) for
+ * entry blocks of 'always' blocks, the identifiers of the trigger.  Both are
+ * stored as sorted symbol vectors.
+ *
+ * The guards of a block are its nearest guard (the first block up the
+ * dominator tree that the block does not postdominate), plus the guards of
+ * that block, so the implicit-flow sets are built along this chain.
+ */
+void module_t::build_block_summaries() {
+    uint32_t count = bb_table.size();
 
-    // IMPORTANT: When processing connections, we flip the def and use flags.
+    imm_guard.assign(count, util_t::k_no_index);
+    implicit_ids.assign(count, id_list_t());
+    trigger_ids.assign(count, id_list_t());
 
-    if (connection.state & STATE_USE) {
-        // This pin is set by the invoked module.
+    for (uint32_t idx = 0; idx < count; idx++) {
+        uint32_t entry_idx = flow_graph.entry_block(idx);
 
-        if (connection.id_set.size() > 1) {
-            assert(false && "simultaneous definition of more than one id!");
-            return false;
+        if (entry_idx == util_t::k_no_index || entry_idx == idx) {
+            continue;
         }
 
-        if (connection.id_set.size() == 1) {
-            id_set_t::iterator it = connection.id_set.begin();
-            const identifier_t& id = *it;
+        uint32_t hi_idx = idx;
 
-            add_def(id, invocation);
-            invoked_module->add_use(connection.remote_endpoint, invocation);
+        while (hi_idx != util_t::k_no_index && postdominates(idx, hi_idx)) {
+            hi_idx = imm_dominator[hi_idx];
         }
+
+        imm_guard[idx] = hi_idx;
     }
 
-    if (connection.state & STATE_DEF) {
-        // This pin is read by the invoked module.
+    std::vector<bool> done(count, false);
+    index_list_t chain;
 
-        for (const identifier_t& id : connection.id_set) {
-            add_use(id, invocation);
+    for (uint32_t idx = 0; idx < count; idx++) {
+        chain.clear();
+
+        for (uint32_t iter = idx; iter != util_t::k_no_index &&
+                done[iter] == false; iter = imm_guard[iter]) {
+            chain.push_back(iter);
         }
 
-        invoked_module->add_def(connection.remote_endpoint, invocation);
-    }
+        // Guards are strict dominators, so compute from the top down.
+        for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+            uint32_t guard_idx = imm_guard[*it];
+            done[*it] = true;
 
-    return true;
-}
+            if (guard_idx == util_t::k_no_index) {
+                continue;
+            }
 
-void module_t::resolve_invoke(invoke_t* invocation, module_map_t& module_map) {
-    identifier_t mod_name = invocation->module_name();
-    module_map_t::iterator it = module_map.find(mod_name);
+            cmpr_t* comparison = bb_table[guard_idx]->comparison();
+            assert(comparison != nullptr && "invalid comparison!");
 
-    if (it == module_map.end()) {
-        util_t::fatal("referred module: " + mod_name + " in module " + name() +
-                "\n");
+            id_list_t& guard_ids = implicit_ids[guard_idx];
+            id_set_t& cmpr_ids = comparison->uses();
 
-        assert(false && "found reference to undefined module!");
-        return;
+            std::set_union(guard_ids.begin(), guard_ids.end(),
+                    cmpr_ids.begin(), cmpr_ids.end(),
+                    std::back_inserter(implicit_ids[*it]));
+        }
     }
 
-    module_t* module = it->second;
+    for (uint32_t entry_idx : flow_graph.entry_blocks()) {
+        if (flow_graph.block_type(entry_idx) != BB_ALWAYS) {
+            continue;
+        }
 
-    for (conn_t& connection : invocation->connections()) {
-        identifier_t end_id = connection.remote_endpoint;
+        instr_list_t& instrs = bb_table[entry_idx]->instrs();
 
-        connection.state = module->arg_state(end_id);
-        process_connection(connection, invocation, module);
+        if (instrs.size() > 0 && instrs.front()->kind() == INSTR_TRIGGER) {
+            trigger_t* trigger = static_cast<trigger_t*>(instrs.front());
+            id_set_t& ids = trigger->trigger_ids();
+
+            trigger_ids[entry_idx].assign(ids.begin(), ids.end());
+        }
     }
+
+    invert_block_summaries();
 }
 
-/*! \brief match module invocations with module definitions.
+/*! \brief index the blocks of this module by the identifiers that flow
+ * implicitly into them, and by the triggers of their 'always' blocks.
  */
-void module_t::resolve_links(module_map_t& module_map) {
+void module_t::invert_block_summaries() {
+    guarded_blocks.clear();
+    triggered_blocks.clear();
+
     for (bb_t* bb : basicblocks) {
-        for (instr_t* instr : bb->instrs()) {
-            if (invoke_t* invocation = dynamic_cast<invoke_t*>(instr)) {
-                resolve_invoke(invocation, module_map);
-            }
+        uint32_t idx = bb->index();
+
+        if (idx >= bb_table.size() || bb->instrs().size() == 0) {
+            continue;
         }
-    }
-}
 
-void module_t::print_undef_ids() {
-    id_set_t undef_ids;
+        for (symbol_t id : implicit_ids[idx]) {
+            guarded_blocks[id].push_back(idx);
+        }
 
-    for (id_map_t::iterator it = use_map.begin(); it != use_map.end(); it++) {
-        identifier_t id = it->first;
-        id_map_t::iterator def_it = def_map.find(id);
+        uint32_t entry_idx = flow_graph.entry_block(idx);
 
-        if (def_it == def_map.end()) {
-            undef_ids.insert(id);
+        if (entry_idx == util_t::k_no_index) {
+            continue;
+        }
+
+        for (symbol_t id : trigger_ids[entry_idx]) {
+            triggered_blocks[id].push_back(idx);
         }
     }
+}
 
-    if (undef_ids.size() > 0) {
-        char message[1024];
-        snprintf(message, sizeof(message), "found %zd undefined identifier(s) "
-                "in module '%s'.\n", undef_ids.size(), mod_name.c_str());
+/*! \brief identifiers that flow implicitly into the requested block.
+ *
+ * These are the uses of all comparisons that guard the block.
+ */
+id_list_t& module_t::implicit_flow_ids(bb_t* bb) {
+    return implicit_ids[bb->index()];
+}
 
-        util_t::plain("\n");
-        util_t::warn(message);
+/*! \brief trigger identifiers of the 'always' block containing 'bb'.
+ *
+ * Empty unless the entry block of 'bb' is an 'always' block.
+ */
+id_list_t& module_t::timing_trigger_ids(bb_t* bb) {
+    return trigger_ids[flow_graph.entry_block(bb->index())];
+}
 
-        util_t::dump_set(undef_ids);
-    }
+/*! \brief check whether 'bb' belongs to a triggered 'always' block, whose
+ * definitions are registers (see timing_trigger_ids()).
+ */
+bool module_t::clocked_block(bb_t* bb) {
+    return timing_trigger_ids(bb).size() > 0;
 }
 
-void module_t::add_arg(identifier_t name, uint8_t state) {
-    arg_states.emplace(name, state);
+/*! \brief blocks into which an identifier flows implicitly, i.e. the
+ * blocks for which implicit_flow_ids() contains it.
+ */
+index_list_t& module_t::implicit_flow_blocks(symbol_t id) {
+    static index_list_t k_no_blocks;
+
+    id_index_map_t::iterator it = guarded_blocks.find(id);
+    return it == guarded_blocks.end() ? k_no_blocks : it->second;
 }
 
-void module_t::update_arg(identifier_t name, uint8_t state) {
-    arg_states[name] = state;
+/*! \brief blocks whose 'always' block is triggered by an identifier, i.e. the
+ * blocks for which timing_trigger_ids() contains it.
+ */
+index_list_t& module_t::timing_trigger_blocks(symbol_t id) {
+    static index_list_t k_no_blocks;
+
+    id_index_map_t::iterator it = triggered_blocks.find(id);
+    return it == triggered_blocks.end() ? k_no_blocks : it->second;
 }
 
-uint8_t module_t::arg_state(identifier_t name) {
-    id_state_map_t::iterator it = arg_states.find(name);
+/*! \brief find the immediate dominator and postdominator of each basic block.
+ *
+ * Builds the dominator and postdominator trees of the module's CFG using the
+ * Lengauer-Tarjan algorithm (see util_t::build_dominator_tree()).  The
+ * dominator forest is rooted at the entry blocks, and the postdominator
+ * forest at the blocks without successors.
+ */
+void module_t::build_dominator_sets() {
+    build_dominator_trees(true);
+}
 
-    if (it == arg_states.end()) {
-        return STATE_UNKNOWN;
-    }
+/*! \brief same as build_dominator_sets(), without progress messages.
+ *
+ * Meant for threads that build dominators in the background.
+ */
+void module_t::warm_dominator_sets() {
+    build_dominator_trees(false);
+}
 
-    return it->second;
+/*! \brief check whether the dominator trees have been built already.
+ */
+bool module_t::dominators_ready() {
+    return empty_dominators == false;
 }
 
-void module_t::process_module_items(Array* module_items) {
-    if (module_items == nullptr || module_items->Size() == 0) {
+void module_t::build_dominator_trees(bool show_progress) {
+    if (empty_dominators == false) {
         return;
     }
 
-    uint32_t idx = 0;
-    VeriModuleItem* module_item = nullptr;
+    std::lock_guard<std::mutex> guard(dominator_lock);
+
+    // Another query may have built them while we waited.
+    if (empty_dominators == false) {
+        return;
+    }
+
+    if (show_progress) {
+        char message[128];
+        snprintf(message, sizeof(message), "building dominators for module "
+                "%s... ", name().substr(0, 8).c_str());
+        util_t::update_status(message);
+    }
+
+    csr_t& succs = flow_graph.successors();
+    csr_t& preds = flow_graph.predecessors();
+
+    index_list_t exit_blocks;
+
+    for (uint32_t idx = 0; idx < flow_graph.size(); idx++) {
+        if (succs[idx].size() == 0) {
+            exit_blocks.push_back(idx);
+        }
+    }
+
+    util_t::build_dominator_tree(succs, preds, flow_graph.entry_blocks(),
+            imm_dominator);
+    util_t::build_dominator_tree(preds, succs, exit_blocks, imm_postdominator);
+
+    number_postdominator_tree();
+    build_block_summaries();
+
+    empty_dominators = false;
+}
+
+/*! \brief compare the dominator trees against the iterative algorithm.
+ *
+ * Returns false (and prints the offending blocks) if any immediate dominator
+ * or postdominator differs between the two algorithms.
+ */
+bool module_t::check_dominator_sets() {
+    build_dominator_sets();
+
+    bb_map_t ref_dominator, ref_postdominator;
+
+    for (bb_t* bb : top_level_blocks) {
+        bb_set_t reachable;
+        util_t::build_reachable_set(bb, reachable);
+        build_dominator_sets(reachable, ref_dominator, ref_postdominator);
+    }
+
+    bool match = true;
+
+    for (auto& entry : ref_dominator) {
+        if (immediate_dominator(entry.first) != entry.second) {
+            util_t::warn("immediate dominator mismatch for block " +
+                    entry.first->name() + " in module " + name() + "\n");
+            match = false;
+        }
+    }
+
+    for (auto& entry : ref_postdominator) {
+        if (immediate_postdominator(entry.first) != entry.second) {
+            util_t::warn("immediate postdominator mismatch for block " +
+                    entry.first->name() + " in module " + name() + "\n");
+            match = false;
+        }
+    }
+
+    return match;
+}
+
+/*! \brief find the definitions and uses of each instruction in this module.
+ */
+void module_t::build_def_use_chains() {
+    for (bb_t* bb : basicblocks) {
+        for (instr_t* instr : bb->instrs()) {
+            for (symbol_t id : instr->defs()) {
+                add_def(id, instr);
+            }
+
+            for (symbol_t id : instr->uses()) {
+                add_use(id, instr);
+            }
+        }
+    }
+}
+
+/*! \brief add the def-use edges of a connection to a module instance.
+ *
+ * Edges of this module are added directly; those of the invoked module are
+ * appended to 'remote_links' (see add_links()).
+ */
+bool module_t::process_connection(conn_t& connection, invoke_t* invocation,
+        module_t* invoked_module, link_list_t& remote_links) {
+    if (connection.state == STATE_UNKNOWN) {
+        return false;
+    }
+
+    // IMPORTANT: When processing connections, we flip the def and use flags.
+
+    if (connection.state & STATE_USE) {
+        // This pin is set by the invoked module.
+
+        if (connection.id_set.size() > 1) {
+            assert(false && "simultaneous definition of more than one id!");
+            return false;
+        }
+
+        if (connection.id_set.size() == 1) {
+            id_set_t::iterator it = connection.id_set.begin();
+            symbol_t id = *it;
+
+            add_def(id, invocation);
+
+            link_t link = { invoked_module, connection.remote_endpoint,
+                invocation, false };
+            remote_links.push_back(link);
+        }
+    }
+
+    if (connection.state & STATE_DEF) {
+        // This pin is read by the invoked module.
+
+        for (symbol_t id : connection.id_set) {
+            add_use(id, invocation);
+        }
+
+        link_t link = { invoked_module, connection.remote_endpoint,
+            invocation, true };
+        remote_links.push_back(link);
+    }
+
+    return true;
+}
+
+void module_t::resolve_invoke(invoke_t* invocation, module_map_t& module_map,
+        link_list_t& remote_links) {
+    identifier_t mod_name = invocation->module_name();
+    module_map_t::iterator it = module_map.find(mod_name);
+
+    if (it == module_map.end()) {
+        util_t::fatal("referred module: " + mod_name + " in module " + name() +
+                "\n");
+
+        assert(false && "found reference to undefined module!");
+        return;
+    }
+
+    module_t* module = it->second;
+
+    for (conn_t& connection : invocation->connections()) {
+        symbol_t end_id = connection.remote_endpoint;
+
+        connection.state = module->arg_state(end_id);
+        process_connection(connection, invocation, module, remote_links);
+    }
+}
+
+/*! \brief match module invocations with module definitions.
+ */
+void module_t::resolve_links(module_map_t& module_map) {
+    link_list_t remote_links;
+    resolve_links(module_map, remote_links);
+
+    for (link_t& link : remote_links) {
+        if (link.def) {
+            link.module_ds->add_def(link.id, link.instr);
+        } else {
+            link.module_ds->add_use(link.id, link.instr);
+        }
+    }
+}
+
+/*! \brief match module invocations with module definitions.
+ *
+ * Only this module is modified; the def-use edges that belong to the invoked
+ * modules are appended to 'remote_links' instead, so that several modules
+ * can be resolved concurrently.
+ */
+void module_t::resolve_links(module_map_t& module_map,
+        link_list_t& remote_links) {
+    for (bb_t* bb : basicblocks) {
+        for (instr_t* instr : bb->instrs()) {
+            if (instr->kind() == INSTR_INVOKE) {
+                resolve_invoke(static_cast<invoke_t*>(instr), module_map,
+                        remote_links);
+            }
+        }
+    }
+}
+
+/*! \brief resolve a single module instantiation again, e.g. after the
+ * invoked module was rebuilt (see unlink_invoke()).
+ */
+void module_t::relink_invoke(invoke_t* invocation, module_map_t& module_map) {
+    link_list_t remote_links;
+    resolve_invoke(invocation, module_map, remote_links);
+
+    for (link_t& link : remote_links) {
+        if (link.def) {
+            link.module_ds->add_def(link.id, link.instr);
+        } else {
+            link.module_ds->add_use(link.id, link.instr);
+        }
+    }
+}
+
+/*! \brief undo the def-use edges that resolving an instantiation added.
+ *
+ * Edges are removed from this module and, unless it is null, from the
+ * invoked module.
+ */
+void module_t::unlink_invoke(invoke_t* invocation, module_t* invoked_module) {
+    for (conn_t& connection : invocation->connections()) {
+        for (symbol_t id : connection.id_set) {
+            remove_instr(def_map, id, invocation);
+            remove_instr(use_map, id, invocation);
+        }
+
+        if (invoked_module != nullptr) {
+            symbol_t end_id = connection.remote_endpoint;
+
+            invoked_module->remove_instr(invoked_module->def_map, end_id,
+                    invocation);
+            invoked_module->remove_instr(invoked_module->use_map, end_id,
+                    invocation);
+        }
+    }
+}
+
+/*! \brief add def-use edges recorded by other modules' resolve_links().
+ */
+void module_t::add_links(link_list_t& links) {
+    for (link_t& link : links) {
+        assert(link.module_ds == this && "link to another module!");
+
+        if (link.def) {
+            add_def(link.id, link.instr);
+        } else {
+            add_use(link.id, link.instr);
+        }
+    }
+}
+
+void module_t::print_undef_ids() {
+    id_set_t undef_ids;
+
+    for (id_map_t::iterator it = use_map.begin(); it != use_map.end(); it++) {
+        symbol_t id = it->first;
+        id_map_t::iterator def_it = def_map.find(id);
+
+        if (def_it == def_map.end()) {
+            undef_ids.insert(id);
+        }
+    }
+
+    if (undef_ids.size() > 0) {
+        char message[1024];
+        snprintf(message, sizeof(message), "found %zd undefined identifier(s) "
+                "in module '%s'.\n", undef_ids.size(), mod_name.c_str());
+
+        util_t::plain("\n");
+        util_t::warn(message);
+
+        util_t::dump_set(undef_ids);
+    }
+}
+
+void module_t::add_arg(symbol_t name, uint8_t state) {
+    arg_states.emplace(name, state);
+}
+
+/*! \brief record a new port, along with its qualified ("module.port") name.
+ */
+void module_t::add_port(symbol_t name, uint8_t state) {
+    add_arg(name, state);
+    arg_ports.insert(name);
+
+    identifier_t qualified_name = mod_name + "." + symtab_t::name(name);
+    qualified_ports[name] = symtab_t::intern(qualified_name);
+}
+
+void module_t::update_arg(symbol_t name, uint8_t state) {
+    arg_states[name] = state;
+}
+
+uint8_t module_t::arg_state(symbol_t name) {
+    id_state_map_t::iterator it = arg_states.find(name);
+
+    if (it == arg_states.end()) {
+        return STATE_UNKNOWN;
+    }
+
+    return it->second;
+}
+
+void module_t::process_module_items(Array* module_items) {
+    if (module_items == nullptr || module_items->Size() == 0) {
+        return;
+    }
+
+    uint32_t idx = 0;
+    VeriModuleItem* module_item = nullptr;
 
     FOREACH_ARRAY_ITEM(module_items, idx, module_item) {
         process_module_item(module_item);
@@ -1227,7 +1936,8 @@ void module_t::process_module_params(Array* params) {
     bb_t* bb_params = create_empty_bb("params", BB_PARAMS, false);
 
     FOREACH_ARRAY_ITEM(params, idx, id_def) {
-        bb_params->append(new param_t(bb_params, id_def->GetName()));
+        symbol_t name = symtab_t::intern(id_def->GetName());
+        bb_params->append(ir_arena.make<param_t>(bb_params, name));
     }
 }
 
@@ -1252,10 +1962,8 @@ void module_t::process_module_ports(Array* port_connects) {
         VeriIdDef* arg_id = nullptr;
 
         FOREACH_ARRAY_ITEM(decl->GetIds(), idx, arg_id) {
-            identifier_t id = arg_id->GetName();
-
-            add_arg(id, state);
-            arg_ports.insert(id);
+            symbol_t id = symtab_t::intern(arg_id->GetName());
+            add_port(id, state);
         }
     }
 }
@@ -1299,17 +2007,17 @@ void module_t::process_module_item(VeriModuleItem* module_item) {
         VeriNetRegAssign* net_reg_assign = nullptr;
 
         FOREACH_ARRAY_ITEM(continuous->GetNetAssigns(), idx, net_reg_assign) {
-            bb->append(new assign_t(bb, net_reg_assign));
+            bb->append(ir_arena.make<assign_t>(bb, net_reg_assign));
         }
     } else if (auto task_decl = dynamic_cast<VeriTaskDecl*>(module_item)) {
         bb_t* bb = create_empty_bb("taskdecl", BB_ORDINARY, false);
-        proc_decl_t* proc_decl = new proc_decl_t(bb, task_decl);
+        proc_decl_t* proc_decl = ir_arena.make<proc_decl_t>(bb, task_decl);
 
         bb->append(proc_decl);
         proc_decls.emplace(proc_decl->name(), proc_decl);
     } else if (auto func_decl = dynamic_cast<VeriFunctionDecl*>(module_item)) {
         bb_t* bb = create_empty_bb("funcdecl", BB_ORDINARY, false);
-        proc_decl_t* proc_decl = new proc_decl_t(bb, func_decl);
+        proc_decl_t* proc_decl = ir_arena.make<proc_decl_t>(bb, func_decl);
 
         bb->append(proc_decl);
         proc_decls.emplace(proc_decl->name(), proc_decl);
@@ -1330,18 +2038,17 @@ void module_t::process_module_item(VeriModuleItem* module_item) {
         }
 
         FOREACH_ARRAY_ITEM(decl->GetIds(), idx, arg_id) {
-            identifier_t port_id = arg_id->GetName();
+            symbol_t port_id = symtab_t::intern(arg_id->GetName());
 
             if (decl->IsIODecl()) {
                 if (port_exists(port_id)) {
-                    update_arg(arg_id->GetName(), state);
+                    update_arg(port_id, state);
                 } else {
-                    add_arg(port_id, state);
-                    arg_ports.insert(port_id);
+                    add_port(port_id, state);
                 }
             }
 
-            bb->append(new data_decl_t(bb, arg_id));
+            bb->append(ir_arena.make<data_decl_t>(bb, arg_id));
         }
     } else if (auto def_param = dynamic_cast<VeriDefParam*>(module_item)) {
         uint32_t idx = 0;
@@ -1349,8 +2056,10 @@ void module_t::process_module_item(VeriModuleItem* module_item) {
         bb_t* bb_params = create_empty_bb("params", BB_PARAMS, false);
 
         FOREACH_ARRAY_ITEM(def_param->GetDefParamAssigns(), idx, param_assign) {
-            identifier_t name = param_assign->GetLVal()->GetName();
-            bb_params->append(new param_t(bb_params, name));
+            const char* lval = param_assign->GetLVal()->GetName();
+            symbol_t name = symtab_t::intern(lval);
+
+            bb_params->append(ir_arena.make<param_t>(bb_params, name));
         }
     } else if (auto module = dynamic_cast<VeriModule*>(module_item)) {
         balk(module, "nested module definitions aren't supported", __FILE__,
@@ -1363,7 +2072,11 @@ void module_t::process_module_item(VeriModuleItem* module_item) {
         const char* module_name = inst->GetModuleName();
 
         FOREACH_ARRAY_ITEM(inst->GetInstances(), idx, module_instance) {
-            bb->append(new invoke_t(bb, module_instance, module_name));
+            invoke_t* invoke = ir_arena.make<invoke_t>(bb, module_instance,
+                    module_name);
+
+            bb->append(invoke);
+            invoke_list.push_back(invoke);
         }
     } else if (auto stmt = dynamic_cast<VeriStatement*>(module_item)) {
         bb_t* bb = create_empty_bb(".dangling", BB_DANGLING, false);
@@ -1383,11 +2096,11 @@ void module_t::process_statement(bb_t*& bb, VeriStatement* stmt) {
     if (util_t::ignored_statement(stmt) == true) {
         ;
     } else if (util_t::ordinary_statement(stmt) == true) {
-        bb->append(new stmt_t(bb, stmt));
+        bb->append(ir_arena.make<stmt_t>(bb, stmt));
     } else if (dynamic_cast<VeriConditionalStatement*>(stmt) != nullptr) {
         bool floating = exists(bb) == false;
 
-        bb->append(new cmpr_t(bb, stmt->GetIfExpr()));
+        bb->append(ir_arena.make<cmpr_t>(bb, stmt->GetIfExpr()));
         bb_t* merge_bb = create_empty_bb("merge", BB_ORDINARY, floating);
 
         bb_t* then_bb = create_empty_bb("then", BB_ORDINARY, floating);
@@ -1425,7 +2138,7 @@ void module_t::process_statement(bb_t*& bb, VeriStatement* stmt) {
         }
 
         assert(bb->block_type() == BB_ALWAYS && "assumption failed!");
-        bb->append(new trigger_t(bb, identifier_set));
+        bb->append(ir_arena.make<trigger_t>(bb, identifier_set));
 
         process_statement(bb, event_ctrl->GetStmt());
     } else if (dynamic_cast<VeriParBlock*>(stmt) != nullptr ||
@@ -1439,7 +2152,7 @@ void module_t::process_statement(bb_t*& bb, VeriStatement* stmt) {
     } else if (auto loop = dynamic_cast<VeriLoop*>(stmt)) {
         process_statement(bb, stmt->GetStmt());
     } else if (auto task_enable = dynamic_cast<VeriTaskEnable*>(stmt)) {
-        bb->append(new proc_call_t(bb, task_enable));
+        bb->append(ir_arena.make<proc_call_t>(bb, task_enable));
     } else {
         balk(stmt, "unhandled node", __FILE__, __LINE__);
     }
@@ -1447,24 +2160,36 @@ void module_t::process_statement(bb_t*& bb, VeriStatement* stmt) {
 
 /*! \brief instructions that define the requested identifier.
  */
-instr_set_t& module_t::def_instrs(identifier_t identifier) {
+instr_set_t& module_t::def_instrs(symbol_t identifier) {
     id_map_t::iterator it = def_map.find(identifier);
 
     if (it == def_map.end()) {
-        util_t::fatal("id: \"" + identifier + "\" in " + name() + "\n");
+        util_t::fatal("id: \"" + symtab_t::name(identifier) + "\" in " +
+                name() + "\n");
         assert(false && "failed to find def for requested id!");
     }
 
     return it->second;
 }
 
+/*! \brief check whether any instruction defines the requested identifier.
+ */
+bool module_t::is_defined(symbol_t identifier) {
+    return def_map.find(identifier) != def_map.end();
+}
+
+bool module_t::is_used(symbol_t identifier) {
+    return use_map.find(identifier) != use_map.end();
+}
+
 /*! \brief instructions that use the requested identifier.
  */
-instr_set_t& module_t::use_instrs(identifier_t identifier) {
+instr_set_t& module_t::use_instrs(symbol_t identifier) {
     id_map_t::iterator it = use_map.find(identifier);
 
     if (it == use_map.end()) {
-        util_t::fatal("id: \"" + identifier + "\" in " + name() + "\n");
+        util_t::fatal("id: \"" + symtab_t::name(identifier) + "\" in " +
+                name() + "\n");
         assert(false && "failed to find use for requested id!");
     }
 
@@ -1485,59 +2210,72 @@ bool module_t::exists(bb_t* bb) {
 }
 
 /*! \brief check whether 'lo' postdominates 'hi'.
+ *
+ * 'lo' postdominates 'hi' iff 'lo' is an ancestor of (or same as) 'hi' in the
+ * postdominator tree, i.e. iff the DFS interval of 'lo' encloses that of 'hi'.
  */
 bool module_t::postdominates(bb_t* lo, bb_t* hi) {
-    if (exists(lo) == false || exists(hi) == false) {
-        assert(hi != nullptr);
+    assert(lo != nullptr && hi != nullptr);
+
+    if (lo->parent() != this || hi->parent() != this) {
+        assert(false && "non-existent blocks as input to postdominates!");
+        return false;
+    }
+
+    return postdominates(lo->index(), hi->index());
+}
+
+bool module_t::postdominates(uint32_t lo_idx, uint32_t hi_idx) {
+    if (pdom_pre[lo_idx] == util_t::k_no_index ||
+            pdom_pre[hi_idx] == util_t::k_no_index) {
         assert(false && "non-existent blocks as input to postdominates!");
         return false;
     }
 
-    bb_set_t& postdom_set = postdominators.at(hi);
-    return postdom_set.find(lo) != postdom_set.end();
+    return pdom_pre[lo_idx] <= pdom_pre[hi_idx] &&
+        pdom_post[hi_idx] <= pdom_post[lo_idx];
+}
+
+/*! \brief basic block with the requested index.
+ */
+bb_t* module_t::block(uint32_t idx) {
+    if (idx >= bb_table.size()) {
+        return nullptr;
+    }
+
+    return bb_table[idx];
 }
 
 /*! \brief retrieve immediate dominators of 'ref_bb'.
  */
 bb_t* module_t::immediate_dominator(bb_t* ref_bb) {
-    bb_map_t::iterator it = imm_dominator.find(ref_bb);
-    if (it == imm_dominator.end()) {
+    if (ref_bb->index() >= imm_dominator.size()) {
         return nullptr;
     }
 
-    return it->second;
+    return block(imm_dominator[ref_bb->index()]);
 }
 
 /*! \brief retrieve immediate postdominators of 'ref_bb'.
  */
 bb_t* module_t::immediate_postdominator(bb_t* ref_bb) {
-    bb_map_t::iterator it = imm_postdominator.find(ref_bb);
-    if (it == imm_postdominator.end()) {
+    if (ref_bb->index() >= imm_postdominator.size()) {
         return nullptr;
     }
 
-    return it->second;
+    return block(imm_postdominator[ref_bb->index()]);
 }
 
 /*! \brief find basic blocks that guard the execution of this basic blocks.
  */
 void module_t::populate_guard_blocks(bb_t* ref_bb, bb_set_t& guard_blocks) {
-    bb_t* hi_block = ref_bb;
-    bb_t* entry_block = ref_bb->entry_block();
-
-    while (hi_block != entry_block) {
-        while (hi_block != nullptr && postdominates(ref_bb, hi_block)) {
-            hi_block = immediate_dominator(hi_block);
-        }
-
-        if (hi_block == nullptr) {
-            break;
-        }
+    uint32_t guard_idx = imm_guard[ref_bb->index()];
 
-        guard_blocks.insert(hi_block);
+    while (guard_idx != util_t::k_no_index) {
+        guard_blocks.insert(bb_table[guard_idx]);
 
         // Continue upwards from the newly discovered condition block.
-        ref_bb = hi_block;
+        guard_idx = imm_guard[guard_idx];
     }
 }
 
@@ -1547,12 +2285,27 @@ id_set_t& module_t::ports() {
     return arg_ports;
 }
 
+/*! \brief module instantiations (invocations) inside this module.
+ */
+invoke_list_t& module_t::invokes() {
+    return invoke_list;
+}
+
 /*! \brief check whether the requested identifier is among the ports.
  */
-bool module_t::port_exists(identifier_t id) {
+bool module_t::port_exists(symbol_t id) {
     return arg_ports.find(id) != arg_ports.end();
 }
 
+/*! \brief symbol of the qualified ("module.port") name of a port.
+ */
+symbol_t module_t::qualified_port(symbol_t id) {
+    id_symbol_map_t::iterator it = qualified_ports.find(id);
+    assert(it != qualified_ports.end() && "not a port of this module!");
+
+    return it->second;
+}
+
 identifier_t module_t::make_unique_bb_id(identifier_t id) {
     // create key if necessary.
     uint32_t counter = bb_id_map[id];
@@ -1564,14 +2317,33 @@ identifier_t module_t::make_unique_bb_id(identifier_t id) {
     return identifier_t(bb_name);
 }
 
-void module_t::add_def(identifier_t def_id, instr_t* def_instr) {
+void module_t::add_def(symbol_t def_id, instr_t* def_instr) {
     def_map[def_id].insert(def_instr);
 }
 
-void module_t::add_use(identifier_t use_id, instr_t* use_instr) {
+void module_t::add_use(symbol_t use_id, instr_t* use_instr) {
     use_map[use_id].insert(use_instr);
 }
 
+/*! \brief remove an instruction from the def or use set of an identifier.
+ *
+ * The entry of the identifier is dropped once it is empty, so that
+ * is_defined() remains accurate.
+ */
+void module_t::remove_instr(id_map_t& id_map, symbol_t id, instr_t* instr) {
+    id_map_t::iterator it = id_map.find(id);
+
+    if (it == id_map.end()) {
+        return;
+    }
+
+    it->second.erase(instr);
+
+    if (it->second.size() == 0) {
+        id_map.erase(it);
+    }
+}
+
 proc_decl_t* module_t::proc_decl_by_id(identifier_t id) {
     proc_decl_map_t::iterator it = proc_decls.find(id);
     if (it == proc_decls.end()) {
@@ -1585,6 +2357,170 @@ bool module_t::is_primitive() {
     return primitive;
 }
 
+/*! \brief build from a list of neighbor lists.
+ */
+void csr_t::build(adj_list_t& lists) {
+    offsets.assign(1, 0);
+    targets.clear();
+
+    for (index_list_t& list : lists) {
+        targets.insert(targets.end(), list.begin(), list.end());
+        offsets.push_back(targets.size());
+    }
+}
+
+/*! \brief build the reverse graph into 'reverse'.
+ *
+ * Neighbors in the reverse graph appear in increasing order.
+ */
+void csr_t::transpose(csr_t& reverse) {
+    uint32_t count = size();
+
+    reverse.offsets.assign(count + 1, 0);
+    reverse.targets.assign(targets.size(), 0);
+
+    for (uint32_t target : targets) {
+        reverse.offsets[target + 1] += 1;
+    }
+
+    for (uint32_t idx = 0; idx < count; idx++) {
+        reverse.offsets[idx + 1] += reverse.offsets[idx];
+    }
+
+    index_list_t cursor(reverse.offsets.begin(), reverse.offsets.end() - 1);
+
+    for (uint32_t idx = 0; idx < count; idx++) {
+        for (uint32_t target : (*this)[idx]) {
+            reverse.targets[cursor[target]++] = idx;
+        }
+    }
+}
+
+/*! \brief count of nodes.
+ */
+uint32_t csr_t::size() {
+    return offsets.size() - 1;
+}
+
+/*! \brief neighbors of the requested node.
+ */
+csr_t::range_t csr_t::operator[](uint32_t idx) {
+    const uint32_t* base = targets.data();
+    return range_t(base + offsets[idx], base + offsets[idx + 1]);
+}
+
+/*! \brief build the CFG from a module's blocks, indexed by bb_t::index().
+ */
+void cfg_t::build(std::vector<bb_t*>& blocks) {
+    uint32_t count = blocks.size();
+    adj_list_t succ_lists(count);
+
+    roots.clear();
+    types.assign(count, BB_ORDINARY);
+    entries.assign(count, util_t::k_no_index);
+
+    for (uint32_t idx = 0; idx < count; idx++) {
+        bb_t* bb = blocks[idx];
+        assert(bb->index() == idx && "unexpected basic block index!");
+
+        types[idx] = bb->block_type();
+
+        if (bb->left_successor() != nullptr) {
+            succ_lists[idx].push_back(bb->left_successor()->index());
+        }
+
+        if (bb->right_successor() != nullptr) {
+            succ_lists[idx].push_back(bb->right_successor()->index());
+        }
+
+        if (bb->pred_count() == 0) {
+            roots.push_back(idx);
+        }
+    }
+
+    succs.build(succ_lists);
+    succs.transpose(preds);
+
+    // Assign entry blocks, using 'entries' as the visited set.
+    index_list_t stack;
+
+    for (uint32_t root : roots) {
+        entries[root] = root;
+        stack.push_back(root);
+
+        while (stack.size() > 0) {
+            uint32_t idx = stack.back();
+            stack.pop_back();
+
+            for (uint32_t succ : succs[idx]) {
+                if (entries[succ] == util_t::k_no_index) {
+                    entries[succ] = root;
+                    stack.push_back(succ);
+                }
+            }
+        }
+    }
+
+    for (uint32_t idx = 0; idx < count; idx++) {
+        if (entries[idx] != util_t::k_no_index) {
+            blocks[idx]->set_entry_block(blocks[entries[idx]]);
+        }
+    }
+}
+
+/*! \brief count of basic blocks.
+ */
+uint32_t cfg_t::size() {
+    return types.size();
+}
+
+/*! \brief blocks without predecessors, in increasing order.
+ */
+index_list_t& cfg_t::entry_blocks() {
+    return roots;
+}
+
+csr_t& cfg_t::successors() {
+    return succs;
+}
+
+csr_t& cfg_t::predecessors() {
+    return preds;
+}
+
+state_t cfg_t::block_type(uint32_t idx) {
+    return types[idx];
+}
+
+/*! \brief entry block that eventually leads to the requested block.
+ */
+uint32_t cfg_t::entry_block(uint32_t idx) {
+    return entries[idx];
+}
+
+/*! \brief blocks reachable from 'start' (including itself).
+ */
+void cfg_t::reachable_set(uint32_t start, index_list_t& reachable) {
+    std::vector<bool> visited(size(), false);
+    index_list_t stack(1, start);
+
+    reachable.clear();
+    visited[start] = true;
+
+    while (stack.size() > 0) {
+        uint32_t idx = stack.back();
+        stack.pop_back();
+        reachable.push_back(idx);
+
+        for (uint32_t succ : succs[idx]) {
+            if (visited[succ] == false) {
+                visited[succ] = true;
+                stack.push_back(succ);
+            }
+        }
+    }
+}
+
 bool util_t::ordinary_statement(VeriStatement* stmt) {
     return dynamic_cast<VeriAssign*>(stmt) != nullptr ||
             dynamic_cast<VeriBlockingAssign*>(stmt) != nullptr ||
@@ -1634,21 +2570,199 @@ uint64_t util_t::build_reachable_set(bb_t*& start_bb, bb_set_t& reachable) {
     return reachable.size();
 }
 
+/*! \brief compute immediate dominators using the Lengauer-Tarjan algorithm.
+ *
+ * The graph is given by 'succs' and 'preds' over dense node indices.  The
+ * search starts from a virtual node that precedes every node in 'roots'.  On
+ * return, 'idom' holds the immediate dominator of every reachable node, or
+ * k_no_index for nodes that are immediately dominated by the virtual node and
+ * for unreachable nodes.  This is the "simple" variant (path compression
+ * without balancing), i.e. O(E log V).
+ */
+void util_t::build_dominator_tree(csr_t& succs, csr_t& preds,
+        index_list_t& roots, index_list_t& idom) {
+    uint32_t count = succs.size();
+    uint32_t root = count;
+
+    index_list_t vertex;
+    index_list_t label(count + 1);
+    index_list_t semi(count + 1, k_no_index);
+    index_list_t parent(count + 1, k_no_index);
+    index_list_t ancestor(count + 1, k_no_index);
+    adj_list_t bucket(count + 1);
+
+    std::vector<bool> is_root(count, false);
+
+    for (uint32_t node : roots) {
+        is_root[node] = true;
+    }
+
+    idom.assign(count + 1, k_no_index);
+
+    auto children = [&](uint32_t node) -> csr_t::range_t {
+        if (node == root) {
+            return csr_t::range_t(roots.data(), roots.data() + roots.size());
+        }
+
+        return succs[node];
+    };
+
+    // Number the nodes in depth-first order.  Verilog statements nest deeply
+    // enough that we avoid recursion here.
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+    semi[root] = 0;
+    label[root] = root;
+    vertex.push_back(root);
+    stack.emplace_back(root, 0);
+
+    while (stack.size() > 0) {
+        uint32_t node = stack.back().first;
+        uint32_t next = stack.back().second;
+
+        csr_t::range_t range = children(node);
+
+        if (next == range.size()) {
+            stack.pop_back();
+            continue;
+        }
+
+        stack.back().second += 1;
+        uint32_t succ = range.begin()[next];
+
+        if (semi[succ] == k_no_index) {
+            parent[succ] = node;
+            semi[succ] = vertex.size();
+            label[succ] = succ;
+
+            vertex.push_back(succ);
+            stack.emplace_back(succ, 0);
+        }
+    }
+
+    index_list_t path;
+
+    auto eval = [&](uint32_t node) -> uint32_t {
+        if (ancestor[node] == k_no_index) {
+            return node;
+        }
+
+        path.clear();
+
+        for (uint32_t iter = node; ancestor[ancestor[iter]] != k_no_index;
+                iter = ancestor[iter]) {
+            path.push_back(iter);
+        }
+
+        // Compress from the top of the forest downwards.
+        for (auto it = path.rbegin(); it != path.rend(); it++) {
+            uint32_t anc = ancestor[*it];
+
+            if (semi[label[anc]] < semi[label[*it]]) {
+                label[*it] = label[anc];
+            }
+
+            ancestor[*it] = ancestor[anc];
+        }
+
+        return label[node];
+    };
+
+    for (uint32_t idx = vertex.size() - 1; idx > 0; idx--) {
+        uint32_t node = vertex[idx];
+
+        for (uint32_t pred : preds[node]) {
+            if (semi[pred] == k_no_index) {
+                // Not reachable from the root.
+                continue;
+            }
+
+            uint32_t candidate = eval(pred);
+
+            if (semi[candidate] < semi[node]) {
+                semi[node] = semi[candidate];
+            }
+        }
+
+        if (is_root[node]) {
+            // The virtual root precedes this node.
+            semi[node] = 0;
+        }
+
+        bucket[vertex[semi[node]]].push_back(node);
+        ancestor[node] = parent[node];
+
+        for (uint32_t dependent : bucket[parent[node]]) {
+            uint32_t candidate = eval(dependent);
+
+            if (semi[candidate] < semi[dependent]) {
+                idom[dependent] = candidate;
+            } else {
+                idom[dependent] = parent[node];
+            }
+        }
+
+        bucket[parent[node]].clear();
+    }
+
+    for (uint32_t idx = 1; idx < vertex.size(); idx++) {
+        uint32_t node = vertex[idx];
+
+        if (idom[node] != vertex[semi[node]]) {
+            idom[node] = idom[idom[node]];
+        }
+    }
+
+    for (uint32_t node = 0; node < count; node++) {
+        if (idom[node] == root) {
+            idom[node] = k_no_index;
+        }
+    }
+
+    idom.resize(count);
+}
+
+/*! \brief names of a set of symbols, in lexicographic order.
+ */
+void util_t::sorted_names(id_set_t& id_set, name_list_t& names) {
+    names.clear();
+    names.reserve(id_set.size());
+
+    for (symbol_t id : id_set) {
+        names.push_back(symtab_t::name(id));
+    }
+
+    std::sort(names.begin(), names.end());
+}
+
 void util_t::clear_status() {
-    util_t::plain("\r                                                        ");
-    util_t::plain("\r");
+    if (show_status == false) {
+        return;
+    }
+
+    util_t::plain("\r                                                        "
+            "\r");
 }
 
 void util_t::update_status(const char* string) {
-    clear_status();
-    util_t::plain(string);
+    if (show_status == false) {
+        return;
+    }
+
+    util_t::plain("\r                                                        "
+            "\r" + identifier_t(string));
 }
 
+/*! \brief print the names of a set of symbols, in lexicographic order.
+ */
 void util_t::dump_set(id_set_t& id_set) {
+    name_list_t names;
+    sorted_names(id_set, names);
+
     uint32_t col = 0;
     util_t::plain("\n    ");
 
-    for (identifier_t id : id_set) {
+    for (identifier_t id : names) {
         if (col + id.size() + 4 > 80) {
             col = 0;
             util_t::plain("\n    " + id + " ");
@@ -1663,7 +2777,7 @@ void util_t::dump_set(id_set_t& id_set) {
 }
 
 proc_decl_t::proc_decl_t(bb_t* parent, VeriTaskDecl* task_decl) :
-        instr_t(nullptr) {
+        instr_t(nullptr, INSTR_PROC_DECL) {
     containing_bb = parent;
     module_t* module_ds = parent->parent();
     id = task_decl->GetSubprogramName()->GetName();
@@ -1683,7 +2797,7 @@ proc_decl_t::proc_decl_t(bb_t* parent, VeriTaskDecl* task_decl) :
 }
 
 proc_decl_t::proc_decl_t(bb_t* parent, VeriFunctionDecl* func_decl) :
-        instr_t(nullptr) {
+        instr_t(nullptr, INSTR_PROC_DECL) {
     containing_bb = parent;
     module_t* module_ds = parent->parent();
     id = func_decl->GetSubprogramName()->GetName();
@@ -1710,28 +2824,21 @@ void proc_decl_t::parse_data_decl(VeriDataDecl* data_decl) {
     }
 
     FOREACH_ARRAY_ITEM(data_decl->GetIds(), idx, arg_id) {
-        identifier_t port_id = arg_id->GetName();
+        symbol_t port_id = symtab_t::intern(arg_id->GetName());
 
         if (data_decl->IsIODecl()) {
             id_desc_t arg = { port_id, state };
             arguments.push_back(arg);
         }
 
-        parent()->append(new data_decl_t(parent(), arg_id));
+        arena_t& arena = parent()->parent()->arena();
+        parent()->append(arena.make<data_decl_t>(parent(), arg_id));
     }
 }
 
 proc_decl_t::~proc_decl_t() {
-    bb_set_t reachable_set;
-    util_t::build_reachable_set(begin_block, reachable_set);
-
-    for (bb_t* bb : reachable_set) {
-        delete bb;
-        bb = nullptr;
-    }
-
+    // The body's basic blocks are owned by the module's arena.
     begin_block = nullptr;
-    reachable_set.clear();
 }
 
 void proc_decl_t::dump() {
@@ -1763,14 +2870,14 @@ id_desc_list_t& proc_decl_t::args() {
 }
 
 proc_call_t::proc_call_t(bb_t* parent, VeriTaskEnable* task_enable) :
-        instr_t(parent) {
+        instr_t(parent, INSTR_PROC_CALL) {
     proc_name = task_enable->GetTaskName()->GetName();
 
     uint32_t idx = 0;
     VeriIdRef* id_ref = nullptr;
 
     FOREACH_ARRAY_ITEM(task_enable->GetArgs(), idx, id_ref) {
-        identifier_t id = id_ref->GetId()->Name();
+        symbol_t id = symtab_t::intern(id_ref->GetId()->Name());
         args.push_back(id);
     }
 
@@ -1800,7 +2907,7 @@ void proc_call_t::set_defs_and_uses() {
     uint32_t idx = 0;
 
     for (id_desc_t formal_arg : proc_decl->args()) {
-        identifier_t arg_id = args[idx];
+        symbol_t arg_id = args[idx];
 
         if (formal_arg.type & STATE_DEF) {
             // This is an input argument to the task.
@@ -1834,6 +2941,154 @@ bool proc_call_t::operator==(const instr_t& reference) {
     return false;
 }
 
+const uint32_t symtab_t::k_first_chunk_bits;
+const uint32_t symtab_t::k_chunk_count;
+
+std::mutex symtab_t::lock;
+std::atomic<identifier_t*> symtab_t::chunks[k_chunk_count];
+std::atomic<uint32_t> symtab_t::count(0);
+std::atomic<symtab_t::index_t*> symtab_t::index(nullptr);
+std::vector<std::unique_ptr<symtab_t::index_t> > symtab_t::indices;
+
+/*! \brief position of 'symbol' counted from the start of an imaginary
+ * first chunk, whose most significant bit selects the chunk.
+ */
+uint64_t symtab_t::position(symbol_t symbol) {
+    return (uint64_t) symbol + (1 << k_first_chunk_bits);
+}
+
+/*! \brief storage of the name of 'symbol', whose chunk must exist.
+ */
+identifier_t& symtab_t::slot(symbol_t symbol) {
+    uint64_t pos = position(symbol);
+    uint32_t bits = 63 - __builtin_clzll(pos);
+
+    identifier_t* chunk = chunks[bits - k_first_chunk_bits];
+    return chunk[pos - ((uint64_t) 1 << bits)];
+}
+
+/*! \brief symbol of 'name' in 'table', or util_t::k_no_index if it is not
+ * there (yet).
+ */
+symbol_t symtab_t::find(index_t* table, const identifier_t& name) {
+    if (table == nullptr) {
+        return util_t::k_no_index;
+    }
+
+    uint32_t pos = std::hash<identifier_t>()(name) & table->mask;
+
+    while (true) {
+        uint32_t entry = table->slots[pos];
+
+        if (entry == 0) {
+            return util_t::k_no_index;
+        }
+
+        if (slot(entry - 1) == name) {
+            return entry - 1;
+        }
+
+        pos = (pos + 1) & table->mask;
+    }
+}
+
+/*! \brief add 'symbol', whose name is stored, to 'table'.
+ */
+void symtab_t::insert(index_t* table, symbol_t symbol) {
+    uint32_t pos = std::hash<identifier_t>()(slot(symbol)) & table->mask;
+
+    while (table->slots[pos] != 0) {
+        pos = (pos + 1) & table->mask;
+    }
+
+    table->slots[pos] = symbol + 1;
+}
+
+/*! \brief replace the index with one of twice the size, keeping the old one
+ * for the readers that may still probe it.
+ */
+void symtab_t::grow() {
+    index_t* table = new index_t;
+    uint32_t capacity = 1 << k_first_chunk_bits;
+
+    if (index != nullptr) {
+        capacity = 2 * (index.load()->mask + 1);
+    }
+
+    table->mask = capacity - 1;
+    table->slots.reset(new std::atomic<uint32_t>[capacity]);
+
+    for (uint32_t pos = 0; pos < capacity; pos++) {
+        table->slots[pos] = 0;
+    }
+
+    for (symbol_t symbol = 0; symbol < count; symbol++) {
+        insert(table, symbol);
+    }
+
+    indices.emplace_back(table);
+    index = table;
+}
+
+/*! \brief symbol for the requested name, creating one if necessary.
+ */
+symbol_t symtab_t::intern(const identifier_t& name) {
+    symbol_t symbol = find(index, name);
+
+    if (symbol != util_t::k_no_index) {
+        return symbol;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    symbol = find(index, name);
+
+    if (symbol != util_t::k_no_index) {
+        return symbol;
+    }
+
+    symbol = count;
+    assert(symbol < util_t::k_no_index - 1 && "too many symbols!");
+
+    // Keep the index at most half full, so that probes stay short.
+    if (index == nullptr || 2 * (symbol + 1) > index.load()->mask + 1) {
+        grow();
+    }
+
+    uint32_t bits = 63 - __builtin_clzll(position(symbol));
+
+    if (chunks[bits - k_first_chunk_bits] == nullptr) {
+        chunks[bits - k_first_chunk_bits] =
+            new identifier_t[(uint64_t) 1 << bits];
+    }
+
+    // Publish the name before the symbol, so that readers who find the
+    // symbol also find its name.
+    slot(symbol) = name;
+    count = symbol + 1;
+    insert(index, symbol);
+
+    return symbol;
+}
+
+/*! \brief name of the requested symbol.
+ */
+const identifier_t& symtab_t::name(symbol_t symbol) {
+    // References stay valid, since chunks never move.
+    assert(symbol < count && "invalid symbol!");
+    return slot(symbol);
+}
+
+/*! \brief count of interned symbols.
+ */
+uint32_t symtab_t::size() {
+    return count;
+}
+
+const uint32_t util_t::k_no_index;
+
+std::atomic<bool> util_t::show_status(true);
+std::mutex util_t::output_lock;
+
 const identifier_t util_t::k_reset = "\033[0m";
 const identifier_t util_t::k_red = "\033[91m";
 const identifier_t util_t::k_yellow = "\033[93m";
@@ -1845,18 +3100,23 @@ const identifier_t util_t::k_warn = util_t::k_yellow + "[WARN]" +
 const identifier_t util_t::k_fatal = util_t::k_red + "[FATAL]" +
         util_t::k_reset + " ";
 
+void util_t::write(const identifier_t& message) {
+    std::lock_guard<std::mutex> guard(output_lock);
+    std::cerr << message;
+}
+
 void util_t::warn(identifier_t message) {
-    std::cerr << k_warn << message;
+    write(k_warn + message);
 }
 
 void util_t::fatal(identifier_t message) {
-    std::cerr << k_fatal << message;
+    write(k_fatal + message);
 }
 
 void util_t::plain(identifier_t message) {
-    std::cerr << k_reset << message;
+    write(k_reset + message);
 }
 
 void util_t::underline(identifier_t message) {
-    std::cerr << k_underline << message << k_reset;
+    write(k_underline + message + k_reset);
 }
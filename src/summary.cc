@@ -0,0 +1,481 @@
+#include <algorithm>
+#include <cassert>
+#include <set>
+
+#include "summary.h"
+
+summary_table_t::summary_table_t(module_map_t& __module_map)
+        : module_map(__module_map) {
+    summary_count = 0;
+}
+
+module_t* summary_table_t::invoked_module(invoke_t* invoke) {
+    module_map_t::iterator it = module_map.find(invoke->module_name());
+
+    if (it == module_map.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+/*! \brief summary of a port of a module, or nullptr if there is none (yet).
+ */
+summary_table_t::summary_t* summary_table_t::lookup(module_t* module_ds,
+        symbol_t port) {
+    summary_map_t::iterator it = summaries.find(module_ds);
+
+    if (it == summaries.end()) {
+        return nullptr;
+    }
+
+    port_summary_map_t::iterator port_it = it->second.find(port);
+
+    if (port_it == it->second.end()) {
+        return nullptr;
+    }
+
+    return &port_it->second;
+}
+
+/*! \brief type of an entry of a summary, applied to a port entered with
+ * 'type'.
+ *
+ * Entering as an ordinary dependence keeps the types of the summary, while
+ * entering as a timing dependence makes every entry a timing dependence.
+ */
+state_t summary_table_t::applied_type(state_t type, state_t entry_type) {
+    state_t result = type & DEP_TIMING;
+
+    if (type & DEP_ORDINARY) {
+        result |= entry_type;
+    }
+
+    return result;
+}
+
+/*! \brief record the types with which a (qualified) port is reached.
+ */
+void summary_table_t::add_port(trace_state_t& state, symbol_t qualified_port,
+        state_t type) {
+    state.ports[qualified_port] |= type;
+}
+
+/*! \brief raise the type of an identifier, re-queuing it if it rises.
+ */
+void summary_table_t::add_new_id(trace_state_t& state, symbol_t id,
+        state_t type) {
+    module_t* module_ds = state.module_ds;
+    state_t& value = state.seen[id];
+
+    if ((type & ~value) == 0) {
+        return;
+    }
+
+    value |= type;
+    state.workset.insert(id);
+
+    if (module_ds->port_exists(id)) {
+        add_port(state, module_ds->qualified_port(id), type);
+    }
+}
+
+/*! \brief follow 'id', defined by an output of 'invoke', through the invoked
+ * module using the summary of that output.
+ */
+void summary_table_t::apply_summary(trace_state_t& state, invoke_t* invoke,
+        symbol_t id, state_t type) {
+    module_t* module_ds = invoked_module(invoke);
+
+    if (module_ds == nullptr) {
+        return;
+    }
+
+    for (conn_t& connection : invoke->connections()) {
+        if ((connection.state & STATE_USE) == 0 ||
+                connection.id_set.find(id) == connection.id_set.end()) {
+            continue;
+        }
+
+        symbol_t port = connection.remote_endpoint;
+
+        if (module_ds->port_exists(port)) {
+            add_port(state, module_ds->qualified_port(port), type);
+        }
+
+        summary_t* summary = lookup(module_ds, port);
+
+        if (summary == nullptr) {
+            continue;
+        }
+
+        for (typed_id_t& entry : summary->ports) {
+            add_port(state, entry.first, applied_type(type, entry.second));
+        }
+
+        // Map the inputs of the invoked module back to this instance's
+        // actual arguments.
+        for (typed_id_t& input : summary->inputs) {
+            state_t input_type = applied_type(type, input.second);
+
+            for (conn_t& actual : invoke->connections()) {
+                if (actual.remote_endpoint != input.first ||
+                        (actual.state & STATE_DEF) == 0) {
+                    continue;
+                }
+
+                for (symbol_t actual_id : actual.id_set) {
+                    add_new_id(state, actual_id, input_type);
+                }
+            }
+        }
+    }
+}
+
+/*! \brief trace the dependences of 'id' within a single module, whose
+ * instances must all be summarized.
+ *
+ * Identifiers without definitions, e.g. unconnected inputs, are reached but
+ * not expanded.
+ */
+void summary_table_t::trace_module(module_t* module_ds, symbol_t id,
+        summary_t& summary, uint64_t& instr_count, cut_set_t* cuts) {
+    trace_state_t state;
+    state.module_ds = module_ds;
+
+    summary.inputs.clear();
+    summary.ports.clear();
+
+    module_ds->build_dominator_sets();
+
+    typed_id_map_t inputs;
+    symbol_t root = id;
+
+    state.seen.emplace(id, DEP_ORDINARY);
+    state.workset.insert(id);
+
+    // Identifiers are re-expanded with their full type whenever it rises;
+    // types only rise, so this reaches the same fixpoint as propagating the
+    // new bits alone.
+    do {
+        id_set_t::iterator it = state.workset.begin();
+
+        symbol_t id = *it;
+        state_t type = state.seen[id];
+
+        state.workset.erase(it);
+
+        if (cuts != nullptr && id != root && cuts->contains(module_ds, id)) {
+            continue;
+        }
+
+        if (module_ds->is_defined(id) == false) {
+            continue;
+        }
+
+        instr_set_t& instr_set = module_ds->def_instrs(id);
+        instr_count += instr_set.size();
+
+        bool external = false;
+
+        for (instr_t* instr : instr_set) {
+            bb_t* bb = instr->parent();
+
+            // Defined by an instance of this module in another module.
+            if (bb->parent() != module_ds) {
+                external = true;
+                continue;
+            }
+
+            if (instr->kind() == INSTR_INVOKE) {
+                apply_summary(state, static_cast<invoke_t*>(instr), id, type);
+            } else {
+                for (symbol_t use : instr->uses()) {
+                    add_new_id(state, use, type);
+                }
+            }
+
+            for (symbol_t guard_id : module_ds->implicit_flow_ids(bb)) {
+                add_new_id(state, guard_id, type);
+            }
+
+            for (symbol_t trigger_id : module_ds->timing_trigger_ids(bb)) {
+                add_new_id(state, trigger_id, DEP_TIMING);
+            }
+        }
+
+        if (external) {
+            inputs[id] |= type;
+        }
+    } while (state.workset.size() > 0);
+
+    summary.inputs.assign(inputs.begin(), inputs.end());
+    summary.ports.assign(state.ports.begin(), state.ports.end());
+}
+
+/*! \brief trace the dependences of 'id' within a single module.
+ *
+ * Instances inside the module are crossed using their summaries, which are
+ * computed first if needed, and the trace stops at the inputs of the module.
+ * The result lists the inputs that were reached and the qualified names of
+ * all ports reached on the way.  Identifiers of 'cuts', if any, other than
+ * 'id' are reached but not expanded.
+ */
+void summary_table_t::trace(module_t* module_ds, symbol_t id,
+        summary_t& summary, uint64_t& instr_count, cut_set_t* cuts) {
+    require(module_ds);
+    trace_module(module_ds, id, summary, instr_count, cuts);
+}
+
+/*! \brief build the instantiation graph, with callees sorted by name.
+ */
+void summary_table_t::build_call_graph(module_list_t& instantiated) {
+    std::set<module_t*> callee_set;
+
+    call_graph.clear();
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        module_t* module_ds = it->second;
+        std::map<identifier_t, module_t*> callees;
+
+        for (invoke_t* invoke : module_ds->invokes()) {
+            module_t* callee = invoked_module(invoke);
+
+            if (callee != nullptr) {
+                callees.emplace(callee->name(), callee);
+                callee_set.insert(callee);
+            }
+        }
+
+        module_list_t& edges = call_graph[module_ds];
+
+        for (auto callee_it = callees.begin(); callee_it != callees.end();
+                callee_it++) {
+            edges.push_back(callee_it->second);
+        }
+    }
+
+    for (auto it = module_map.begin(); it != module_map.end(); it++) {
+        if (callee_set.find(it->second) != callee_set.end()) {
+            instantiated.push_back(it->second);
+        }
+    }
+}
+
+/*! \brief summarize all outputs of a module.
+ *
+ * Returns true if any summary is new or has grown.
+ */
+bool summary_table_t::summarize_module(module_t* module_ds) {
+    bool changed = false;
+    uint64_t instr_count = 0;
+
+    summary_map_t::iterator summary_it = summaries.find(module_ds);
+    assert(summary_it != summaries.end() && "module is not instantiated!");
+
+    port_summary_map_t& port_summaries = summary_it->second;
+
+    for (symbol_t port : module_ds->ports()) {
+        if ((module_ds->arg_state(port) & STATE_USE) == 0) {
+            continue;
+        }
+
+        summary_t summary;
+        trace_module(module_ds, port, summary, instr_count, nullptr);
+
+        port_summary_map_t::iterator it = port_summaries.find(port);
+
+        if (it == port_summaries.end()) {
+            port_summaries.emplace(port, summary);
+            summary_count += 1;
+            changed = true;
+        } else if (summary.inputs != it->second.inputs ||
+                summary.ports != it->second.ports) {
+            it->second = summary;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+/*! \brief summarize a strongly connected component of the instantiation
+ * graph, iterating to a fixpoint if the component is recursive.
+ */
+void summary_table_t::summarize_component(module_list_t& component) {
+    module_t* module_ds = component.front();
+    module_list_t& callees = call_graph[module_ds];
+
+    bool recursive = component.size() > 1 ||
+        std::find(callees.begin(), callees.end(), module_ds) != callees.end();
+
+    if (recursive == false) {
+        summarize_module(module_ds);
+    } else {
+        bool changed = false;
+
+        do {
+            changed = false;
+
+            for (module_t* member : component) {
+                changed = summarize_module(member) || changed;
+            }
+        } while (changed);
+    }
+
+    complete.insert(component.begin(), component.end());
+}
+
+/*! \brief summarize the modules that a module (transitively) instantiates,
+ * unless they are complete already.
+ *
+ * Tarjan's algorithm emits the strongly connected components of the
+ * instantiation graph callees first, so every component only depends on
+ * summaries that are already complete (or on itself).  The search starts at
+ * the callees of the module, so the module itself is only summarized if it
+ * instantiates itself.
+ */
+void summary_table_t::require(module_t* root) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::map<module_t*, uint32_t> index, low;
+    std::set<module_t*> on_stack;
+    module_list_t stack;
+    std::vector<std::pair<module_t*, size_t> > dfs;
+
+    uint32_t counter = 0;
+
+    for (module_t* start : call_graph[root]) {
+        if (complete.find(start) != complete.end() ||
+                index.find(start) != index.end()) {
+            continue;
+        }
+
+        index[start] = low[start] = counter++;
+        stack.push_back(start);
+        on_stack.insert(start);
+        dfs.push_back(std::make_pair(start, 0));
+
+        while (dfs.size() > 0) {
+            module_t* module_ds = dfs.back().first;
+            module_list_t& callees = call_graph[module_ds];
+
+            if (dfs.back().second < callees.size()) {
+                module_t* callee = callees[dfs.back().second++];
+
+                if (complete.find(callee) != complete.end()) {
+                    continue;
+                }
+
+                if (index.find(callee) == index.end()) {
+                    index[callee] = low[callee] = counter++;
+                    stack.push_back(callee);
+                    on_stack.insert(callee);
+                    dfs.push_back(std::make_pair(callee, 0));
+                } else if (on_stack.find(callee) != on_stack.end()) {
+                    low[module_ds] = std::min(low[module_ds], index[callee]);
+                }
+
+                continue;
+            }
+
+            dfs.pop_back();
+
+            if (dfs.size() > 0) {
+                module_t* parent = dfs.back().first;
+                low[parent] = std::min(low[parent], low[module_ds]);
+            }
+
+            if (low[module_ds] != index[module_ds]) {
+                continue;
+            }
+
+            module_list_t component;
+            module_t* member = nullptr;
+
+            do {
+                member = stack.back();
+                stack.pop_back();
+                on_stack.erase(member);
+
+                component.push_back(member);
+            } while (member != module_ds);
+
+            identifier_t status = "summarizing '" + module_ds->name() +
+                "' ... ";
+
+            util_t::update_status(status.c_str());
+            summarize_component(component);
+        }
+    }
+}
+
+/*! \brief prepare the table for the modules of the design.
+ *
+ * This builds the instantiation graph and an entry for every instantiated
+ * module; the summaries themselves are computed by the queries that need
+ * them.  Summaries that survived invalidate() are kept.  This must be called
+ * before the first query, and again whenever the design changes.
+ */
+void summary_table_t::prepare() {
+    module_list_t instantiated;
+    build_call_graph(instantiated);
+
+    for (module_t* module_ds : instantiated) {
+        summaries[module_ds];
+    }
+}
+
+/*! \brief drop the summaries of the named modules and of all modules that
+ * (transitively) instantiate them.
+ *
+ * This must be called while the modules are still in the module map, i.e.
+ * before they are replaced, and followed by prepare() once they are.  Only
+ * the dropped summaries are computed again.
+ */
+void summary_table_t::invalidate(std::set<identifier_t>& names) {
+    std::set<identifier_t> stale(names);
+    bool changed = false;
+
+    do {
+        changed = false;
+
+        for (auto it = module_map.begin(); it != module_map.end(); it++) {
+            if (stale.find(it->first) != stale.end()) {
+                continue;
+            }
+
+            for (invoke_t* invoke : it->second->invokes()) {
+                if (stale.find(invoke->module_name()) != stale.end()) {
+                    stale.insert(it->first);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    } while (changed);
+
+    for (const identifier_t& name : stale) {
+        module_map_t::iterator it = module_map.find(name);
+
+        if (it == module_map.end()) {
+            continue;
+        }
+
+        summary_map_t::iterator summary_it = summaries.find(it->second);
+
+        if (summary_it != summaries.end()) {
+            summary_count -= summary_it->second.size();
+            summaries.erase(summary_it);
+        }
+
+        complete.erase(it->second);
+    }
+}
+
+/*! \brief number of port summaries computed so far.
+ */
+uint64_t summary_table_t::size() {
+    std::lock_guard<std::mutex> guard(lock);
+    return summary_count;
+}